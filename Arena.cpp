@@ -0,0 +1,52 @@
+#include "Arena.h"
+
+#include <algorithm>
+#include <cstring>
+
+Arena::~Arena() {
+    reset();
+}
+
+void *Arena::allocateSlow(size_t size, size_t align) {
+    size_t chunkSize = std::max(CHUNK_SIZE, size + align);
+    char *chunk = static_cast<char *>(::operator new(chunkSize));
+
+    chunks.push_back(chunk);
+    reserved += chunkSize;
+
+    // An oversized allocation gets a chunk of its own and leaves the current chunk in use
+    if (chunkSize > CHUNK_SIZE && cursor != nullptr)
+    {
+        auto aligned = (reinterpret_cast<uintptr_t>(chunk) + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+        used += size;
+        return reinterpret_cast<void *>(aligned);
+    }
+
+    cursor = chunk;
+    limit = chunk + chunkSize;
+    return allocate(size, align);
+}
+
+std::string_view Arena::copyString(std::string_view text) {
+    if (text.empty())
+    {
+        return {};
+    }
+
+    char *copy = static_cast<char *>(allocate(text.size(), 1));
+    std::memcpy(copy, text.data(), text.size());
+    return {copy, text.size()};
+}
+
+void Arena::reset() {
+    for (char *chunk : chunks)
+    {
+        ::operator delete(chunk);
+    }
+
+    chunks.clear();
+    cursor = nullptr;
+    limit = nullptr;
+    used = 0;
+    reserved = 0;
+}
@@ -0,0 +1,111 @@
+#ifndef RPAL_FINAL_ARENA_H
+#define RPAL_FINAL_ARENA_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+/**
+ * @brief A bump-pointer allocator that frees everything it handed out at once.
+ *
+ * Memory is carved out of large chunks by advancing a pointer, so an allocation costs a few
+ * instructions and objects that are built together sit next to each other. Nothing is freed
+ * individually: destroying or resetting the arena releases every chunk in one go. Objects
+ * placed in an arena must therefore be trivially destructible; make() enforces this.
+ */
+class Arena
+{
+public:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024; // Size of a regular chunk
+
+    Arena() = default;
+
+    ~Arena();
+
+    Arena(const Arena &) = delete;
+
+    Arena &operator=(const Arena &) = delete;
+
+    /**
+     * @brief Returns uninitialized memory for size bytes with the given alignment.
+     * @param size The number of bytes.
+     * @param align The alignment, a power of two no larger than alignof(std::max_align_t).
+     * @return The memory, valid until the arena is reset or destroyed.
+     */
+    void *allocate(size_t size, size_t align = alignof(std::max_align_t))
+    {
+        auto current = reinterpret_cast<uintptr_t>(cursor);
+        uintptr_t aligned = (current + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+
+        if (cursor == nullptr || aligned + size > reinterpret_cast<uintptr_t>(limit))
+        {
+            return allocateSlow(size, align);
+        }
+
+        cursor = reinterpret_cast<char *>(aligned + size);
+        used += size;
+        return reinterpret_cast<void *>(aligned);
+    }
+
+    /**
+     * @brief Constructs a T in the arena.
+     * @param args The constructor arguments.
+     * @return The new object. It is never destroyed, only released with the arena.
+     */
+    template<typename T, typename... Args>
+    T *make(Args &&... args)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "Arena objects are never destroyed");
+        return new(allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Copies a string into the arena.
+     * @param text The string to copy.
+     * @return A view of the copy, valid until the arena is reset or destroyed.
+     */
+    std::string_view copyString(std::string_view text);
+
+    /**
+     * @brief Releases every chunk. All memory handed out so far becomes invalid.
+     */
+    void reset();
+
+    /**
+     * @brief Returns the number of bytes handed out since the arena was created or reset.
+     */
+    [[nodiscard]] size_t bytesUsed() const
+    {
+        return used;
+    }
+
+    /**
+     * @brief Returns the number of bytes held in chunks, used or not.
+     */
+    [[nodiscard]] size_t bytesReserved() const
+    {
+        return reserved;
+    }
+
+private:
+    /**
+     * @brief Starts a new chunk large enough for the allocation and allocates from it.
+     */
+    void *allocateSlow(size_t size, size_t align);
+
+private:
+    std::vector<char *> chunks; // Every chunk, for release
+    char *cursor = nullptr;     // Next free byte of the current chunk
+    char *limit = nullptr;      // End of the current chunk
+    size_t used = 0;            // Bytes handed out
+    size_t reserved = 0;        // Bytes in chunks
+};
+
+
+#endif //RPAL_FINAL_ARENA_H
@@ -0,0 +1,145 @@
+#include "Batch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "SourceBuffer.h"
+#include "Parser.h"
+#include "CSE.h"
+#include "WorkStealingPool.h"
+
+/**
+ * Compiles and evaluates one program, writing what it prints to out.
+ */
+static void interpret(const std::string &path, std::ostream &out)
+{
+    SourceBuffer source(path);
+
+    if (!source.isOpen())
+    {
+        throw std::runtime_error("Unable to open file: " + path);
+    }
+
+    // Errors in the source are reported alongside the program's output, not interleaved on the
+    // shared standard error with those of programs running on other threads
+    Lexer lexer(source.view(), defaultScanKernels(), out);
+    CompilationContext ctx(lexer);
+
+    Parser::parse(ctx);
+    ctx.tokenStorage.clear();
+    ctx.tree.generate();
+
+    CSE cse(out);
+    cse.create_cs(ctx.tree.getSTRoot());
+    cse.evaluate();
+
+    out << "\n";
+}
+
+std::vector<std::string> collectBatchInputs(const std::string &path)
+{
+    std::vector<std::string> files;
+
+    if (std::filesystem::is_directory(path))
+    {
+        for (const auto &entry : std::filesystem::directory_iterator(path))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".rpal")
+            {
+                files.push_back(entry.path().string());
+            }
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    std::ifstream list(path);
+    if (!list.is_open())
+    {
+        throw std::runtime_error("Unable to open batch list: " + path);
+    }
+
+    std::string line;
+    while (std::getline(list, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        if (!line.empty())
+        {
+            files.push_back(line);
+        }
+    }
+    return files;
+}
+
+std::vector<BatchResult> runBatch(const std::vector<std::string> &files, unsigned threads)
+{
+    std::vector<BatchResult> results(files.size());
+    WorkStealingPool pool(threads);
+
+    pool.run(files.size(), [&](size_t i) {
+        BatchResult &result = results[i];
+        result.path = files[i];
+
+        std::ostringstream out;
+        auto start = std::chrono::steady_clock::now();
+
+        try
+        {
+            interpret(files[i], out);
+        }
+        catch (const std::exception &e)
+        {
+            out << "Error: " << e.what() << "\n";
+            result.failed = true;
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        result.milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+        result.output = out.str();
+    });
+
+    return results;
+}
+
+void writeBatchResults(const std::vector<BatchResult> &results, std::ostream &out)
+{
+    for (const BatchResult &result : results)
+    {
+        out << "==> " << result.path << " <==\n" << result.output;
+    }
+    out.flush();
+}
+
+void writeBatchSummary(const std::vector<BatchResult> &results, unsigned threads, double wallMilliseconds,
+                       std::ostream &out)
+{
+    size_t failed = 0;
+    double total = 0;
+    const BatchResult *slowest = nullptr;
+
+    for (const BatchResult &result : results)
+    {
+        failed += result.failed ? 1 : 0;
+        total += result.milliseconds;
+        if (slowest == nullptr || result.milliseconds > slowest->milliseconds)
+        {
+            slowest = &result;
+        }
+    }
+
+    out << "Programs: " << results.size() << " (" << failed << " failed) on " << threads << " threads\n";
+    out << "Wall time: " << wallMilliseconds << " ms\n";
+    out << "Program time: " << total << " ms total, "
+        << (results.empty() ? 0.0 : total / static_cast<double>(results.size())) << " ms mean\n";
+    if (slowest != nullptr)
+    {
+        out << "Slowest: " << slowest->path << " (" << slowest->milliseconds << " ms)\n";
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef RPAL_FINAL_BATCH_H
+#define RPAL_FINAL_BATCH_H
+
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+/**
+ * @brief The outcome of running one program in batch mode.
+ */
+struct BatchResult
+{
+    std::string path;         // The program file
+    std::string output;       // Everything the program printed, or the error that stopped it
+    double milliseconds = 0;  // Time spent compiling and evaluating the program
+    bool failed = false;      // Whether the program could not be read, compiled or evaluated
+};
+
+/**
+ * @brief Lists the programs named by a batch argument.
+ *
+ * A directory stands for every .rpal file directly inside it, in name order. Any other path is
+ * read as a list of program paths, one per line; blank lines are skipped.
+ *
+ * @param path The directory or list file.
+ * @return The program paths, in input order.
+ * @throws std::runtime_error if the path cannot be read.
+ */
+std::vector<std::string> collectBatchInputs(const std::string &path);
+
+/**
+ * @brief Runs every program on a work-stealing pool within this process.
+ *
+ * Each program gets its own CompilationContext and CSE machine, and its output, including any
+ * errors the lexer reports in its source, is captured separately. Results are returned in input order regardless of which thread ran them.
+ *
+ * @param files The programs to run.
+ * @param threads The number of worker threads; zero means one per hardware thread.
+ * @return One result per program, in the order of files.
+ */
+std::vector<BatchResult> runBatch(const std::vector<std::string> &files, unsigned threads);
+
+/**
+ * @brief Writes the output of each program, in input order, under a header naming the file.
+ * @param results The results of runBatch().
+ * @param out The stream to write to.
+ */
+void writeBatchResults(const std::vector<BatchResult> &results, std::ostream &out);
+
+/**
+ * @brief Writes the program count, failures and timing of a batch run.
+ * @param results The results of runBatch().
+ * @param threads The number of worker threads used.
+ * @param wallMilliseconds The elapsed time of the whole run.
+ * @param out The stream to write to.
+ */
+void writeBatchSummary(const std::vector<BatchResult> &results, unsigned threads, double wallMilliseconds,
+                       std::ostream &out);
+
+
+#endif //RPAL_FINAL_BATCH_H
@@ -0,0 +1,616 @@
+#include "BigInt.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+
+using Limbs = std::vector<uint32_t>;
+
+static constexpr uint32_t DECIMAL_BASE = 1000000000; // Largest power of ten that fits in a limb
+static constexpr size_t DECIMAL_BASE_DIGITS = 9;
+
+static void trim(Limbs &limbs)
+{
+    while (!limbs.empty() && limbs.back() == 0)
+    {
+        limbs.pop_back();
+    }
+}
+
+static int compareMagnitudes(const Limbs &left, const Limbs &right)
+{
+    if (left.size() != right.size())
+    {
+        return left.size() < right.size() ? -1 : 1;
+    }
+    for (size_t i = left.size(); i-- > 0;)
+    {
+        if (left[i] != right[i])
+        {
+            return left[i] < right[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Adds two limb sequences, which need not be trimmed.
+ */
+static Limbs addLimbs(const uint32_t *left, size_t leftSize, const uint32_t *right, size_t rightSize)
+{
+    if (leftSize < rightSize)
+    {
+        std::swap(left, right);
+        std::swap(leftSize, rightSize);
+    }
+
+    Limbs sum(leftSize + 1);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < leftSize; i++)
+    {
+        carry += static_cast<uint64_t>(left[i]) + (i < rightSize ? right[i] : 0);
+        sum[i] = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+    sum[leftSize] = static_cast<uint32_t>(carry);
+    return sum;
+}
+
+/**
+ * @brief Adds source, shifted up by offset limbs, into target, which is large enough to hold
+ * the result.
+ */
+static void addAt(Limbs &target, size_t offset, const Limbs &source)
+{
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < source.size() && offset + i < target.size(); i++)
+    {
+        carry += static_cast<uint64_t>(target[offset + i]) + source[i];
+        target[offset + i] = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+    for (i += offset; carry != 0 && i < target.size(); i++)
+    {
+        carry += target[i];
+        target[i] = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+}
+
+/**
+ * @brief Subtracts source from target, which must be at least as large.
+ */
+static void subtractFrom(Limbs &target, const Limbs &source)
+{
+    int64_t borrow = 0;
+    size_t i = 0;
+    for (; i < source.size(); i++)
+    {
+        int64_t difference = static_cast<int64_t>(target[i]) - source[i] - borrow;
+        target[i] = static_cast<uint32_t>(difference);
+        borrow = difference < 0;
+    }
+    for (; borrow != 0 && i < target.size(); i++)
+    {
+        borrow = target[i] == 0;
+        target[i]--;
+    }
+}
+
+/**
+ * @brief Adds left * right into product, which holds at least leftSize + rightSize limbs.
+ */
+static void multiplySchoolbook(const uint32_t *left, size_t leftSize, const uint32_t *right, size_t rightSize,
+                               uint32_t *product)
+{
+    for (size_t i = 0; i < leftSize; i++)
+    {
+        uint64_t carry = 0;
+        uint64_t factor = left[i];
+        for (size_t j = 0; j < rightSize; j++)
+        {
+            carry += factor * right[j] + product[i + j];
+            product[i + j] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        for (size_t k = i + rightSize; carry != 0; k++)
+        {
+            carry += product[k];
+            product[k] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+    }
+}
+
+/**
+ * @brief Multiplies two limb sequences, which need not be trimmed, into leftSize + rightSize
+ * limbs.
+ *
+ * Splits both operands in half and makes three half-size products instead of four, once both
+ * are at least KARATSUBA_THRESHOLD limbs. An operand more than twice the length of the other is
+ * first cut into pieces of the shorter one's length, so the halves always overlap.
+ */
+static Limbs multiplyLimbs(const uint32_t *left, size_t leftSize, const uint32_t *right, size_t rightSize)
+{
+    if (leftSize < rightSize)
+    {
+        std::swap(left, right);
+        std::swap(leftSize, rightSize);
+    }
+
+    Limbs product(leftSize + rightSize);
+
+    if (rightSize < BigInt::KARATSUBA_THRESHOLD)
+    {
+        multiplySchoolbook(left, leftSize, right, rightSize, product.data());
+        return product;
+    }
+
+    if (2 * rightSize <= leftSize)
+    {
+        for (size_t offset = 0; offset < leftSize; offset += rightSize)
+        {
+            size_t pieceSize = std::min(rightSize, leftSize - offset);
+            addAt(product, offset, multiplyLimbs(left + offset, pieceSize, right, rightSize));
+        }
+        return product;
+    }
+
+    // left = high * B^half + low, and likewise right; rightSize > half since 2 * rightSize > leftSize
+    size_t half = leftSize / 2;
+    Limbs lows = multiplyLimbs(left, half, right, half);
+    Limbs highs = multiplyLimbs(left + half, leftSize - half, right + half, rightSize - half);
+    Limbs leftSum = addLimbs(left, half, left + half, leftSize - half);
+    Limbs rightSum = addLimbs(right, half, right + half, rightSize - half);
+
+    // (lowLeft + highLeft)(lowRight + highRight) - lows - highs is the sum of the cross products
+    Limbs cross = multiplyLimbs(leftSum.data(), leftSum.size(), rightSum.data(), rightSum.size());
+    subtractFrom(cross, lows);
+    subtractFrom(cross, highs);
+
+    addAt(product, 0, lows);
+    addAt(product, half, cross);
+    addAt(product, 2 * half, highs);
+    return product;
+}
+
+/**
+ * @brief Divides limbs in place by a single limb.
+ * @return The remainder.
+ */
+static uint32_t divideBySmall(Limbs &limbs, uint32_t divisor)
+{
+    uint64_t remainder = 0;
+    for (size_t i = limbs.size(); i-- > 0;)
+    {
+        uint64_t current = (remainder << 32) | limbs[i];
+        limbs[i] = static_cast<uint32_t>(current / divisor);
+        remainder = current % divisor;
+    }
+    trim(limbs);
+    return static_cast<uint32_t>(remainder);
+}
+
+/**
+ * @brief Sets limbs to limbs * factor + addend.
+ */
+static void multiplyAddSmall(Limbs &limbs, uint32_t factor, uint32_t addend)
+{
+    uint64_t carry = addend;
+    for (uint32_t &limb : limbs)
+    {
+        carry += static_cast<uint64_t>(limb) * factor;
+        limb = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+    if (carry != 0)
+    {
+        limbs.push_back(static_cast<uint32_t>(carry));
+    }
+}
+
+/**
+ * @brief Divides two trimmed magnitudes (Knuth's algorithm D).
+ * @param remainder If not null, receives the trimmed remainder.
+ */
+static Limbs divideMagnitudes(const Limbs &dividend, const Limbs &divisor, Limbs *remainder = nullptr)
+{
+    if (compareMagnitudes(dividend, divisor) < 0)
+    {
+        if (remainder != nullptr)
+        {
+            *remainder = dividend;
+        }
+        return {};
+    }
+    if (divisor.size() == 1)
+    {
+        Limbs quotient = dividend;
+        uint32_t rest = divideBySmall(quotient, divisor[0]);
+        if (remainder != nullptr)
+        {
+            *remainder = rest != 0 ? Limbs{rest} : Limbs{};
+        }
+        return quotient;
+    }
+
+    // Shift both so the divisor's top limb has its high bit set, which keeps each estimated
+    // quotient limb at most two too large
+    int shift = 0;
+    while ((divisor.back() << shift & 0x80000000u) == 0)
+    {
+        shift++;
+    }
+    size_t n = divisor.size();
+    size_t m = dividend.size() - n;
+
+    Limbs v(n);
+    for (size_t i = n; i-- > 0;)
+    {
+        v[i] = static_cast<uint32_t>((static_cast<uint64_t>(divisor[i]) << shift) |
+                                     (i > 0 ? static_cast<uint64_t>(divisor[i - 1]) >> (32 - shift) : 0));
+    }
+    Limbs u(dividend.size() + 1);
+    u[dividend.size()] = static_cast<uint32_t>(static_cast<uint64_t>(dividend.back()) >> (32 - shift));
+    for (size_t i = dividend.size(); i-- > 0;)
+    {
+        u[i] = static_cast<uint32_t>((static_cast<uint64_t>(dividend[i]) << shift) |
+                                     (i > 0 ? static_cast<uint64_t>(dividend[i - 1]) >> (32 - shift) : 0));
+    }
+
+    Limbs quotient(m + 1);
+    for (size_t j = m + 1; j-- > 0;)
+    {
+        uint64_t top = (static_cast<uint64_t>(u[j + n]) << 32) | u[j + n - 1];
+        uint64_t estimate = top / v[n - 1];
+        uint64_t rest = top % v[n - 1];
+        while (estimate > UINT32_MAX || estimate * v[n - 2] > ((rest << 32) | u[j + n - 2]))
+        {
+            estimate--;
+            rest += v[n - 1];
+            if (rest > UINT32_MAX)
+            {
+                break;
+            }
+        }
+
+        // u[j .. j + n] -= estimate * v
+        int64_t borrow = 0;
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            uint64_t product = estimate * v[i] + carry;
+            carry = product >> 32;
+            int64_t difference = static_cast<int64_t>(u[i + j]) - borrow - static_cast<int64_t>(product & UINT32_MAX);
+            u[i + j] = static_cast<uint32_t>(difference);
+            borrow = difference < 0;
+        }
+        int64_t difference = static_cast<int64_t>(u[j + n]) - borrow - static_cast<int64_t>(carry);
+        u[j + n] = static_cast<uint32_t>(difference);
+
+        // The estimate was one too large: add the divisor back
+        if (difference < 0)
+        {
+            estimate--;
+            carry = 0;
+            for (size_t i = 0; i < n; i++)
+            {
+                carry += static_cast<uint64_t>(u[i + j]) + v[i];
+                u[i + j] = static_cast<uint32_t>(carry);
+                carry >>= 32;
+            }
+            u[j + n] += static_cast<uint32_t>(carry);
+        }
+        quotient[j] = static_cast<uint32_t>(estimate);
+    }
+
+    // What is left of u below the divisor's length is the remainder, still shifted
+    if (remainder != nullptr)
+    {
+        remainder->resize(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            (*remainder)[i] = static_cast<uint32_t>((static_cast<uint64_t>(u[i]) >> shift) |
+                                                    (static_cast<uint64_t>(u[i + 1]) << (32 - shift)));
+        }
+        trim(*remainder);
+    }
+
+    trim(quotient);
+    return quotient;
+}
+
+/**
+ * @brief Appends the next power to a list of 10^(9 * 2^k) for k = 0, 1, ..., by squaring the last.
+ */
+static void pushDecimalPower(std::vector<Limbs> &powers)
+{
+    if (powers.empty())
+    {
+        powers.push_back({DECIMAL_BASE});
+        return;
+    }
+    const Limbs &last = powers.back();
+    Limbs square = multiplyLimbs(last.data(), last.size(), last.data(), last.size());
+    trim(square);
+    powers.push_back(std::move(square));
+}
+
+/**
+ * @brief Appends a magnitude in decimal, nine digits per pass over its limbs, left-padded with
+ * zeros to width digits; a zero magnitude with no width appends nothing.
+ */
+static void appendDecimalByChunks(Limbs rest, size_t width, std::string &text)
+{
+    std::vector<uint32_t> chunks;
+    while (!rest.empty())
+    {
+        chunks.push_back(divideBySmall(rest, DECIMAL_BASE));
+    }
+
+    std::string digits;
+    for (size_t i = chunks.size(); i-- > 0;)
+    {
+        std::string chunk = std::to_string(chunks[i]);
+        digits.append(DECIMAL_BASE_DIGITS - chunk.size(), '0');
+        digits += chunk;
+    }
+    digits.erase(0, digits.find_first_not_of('0'));
+    if (digits.size() < width)
+    {
+        text.append(width - digits.size(), '0');
+    }
+    text += digits;
+}
+
+/**
+ * @brief Appends a magnitude below powers[level]^2 in decimal, left-padded with zeros to width
+ * digits.
+ *
+ * Dividing by powers[level] splits the value into a high and a low half of 9 * 2^level digits
+ * each, which are converted the same way, so each level does divisions of about half the size of
+ * the level above and the chunked loop only ever sees small values.
+ */
+static void appendDecimal(const Limbs &value, size_t width, const std::vector<Limbs> &powers, size_t level,
+                          std::string &text)
+{
+    if (value.size() < BigInt::DECIMAL_SPLIT_THRESHOLD)
+    {
+        appendDecimalByChunks(value, width, text);
+        return;
+    }
+
+    size_t lowDigits = DECIMAL_BASE_DIGITS << level;
+    if (compareMagnitudes(value, powers[level]) < 0)
+    {
+        appendDecimal(value, width, powers, level - 1, text);
+        return;
+    }
+
+    Limbs low;
+    Limbs high = divideMagnitudes(value, powers[level], &low);
+    appendDecimal(high, width > lowDigits ? width - lowDigits : 0, powers, level - 1, text);
+    appendDecimal(low, lowDigits, powers, level - 1, text);
+}
+
+/**
+ * @brief Parses decimal digits, splitting off the last 9 * 2^level of them when there are more.
+ *
+ * The two parts are parsed the same way and joined with one multiplication by powers[level], so
+ * long literals take a few large Karatsuba products instead of a pass over the limbs per nine
+ * digits.
+ */
+static Limbs parseDecimal(std::string_view digits, const std::vector<Limbs> &powers, size_t level)
+{
+    size_t lowDigits = DECIMAL_BASE_DIGITS << level;
+    if (digits.size() < BigInt::DECIMAL_SPLIT_THRESHOLD * DECIMAL_BASE_DIGITS || level == 0)
+    {
+        // Nine digits at a time: one pass over the limbs per chunk instead of per digit
+        Limbs result;
+        size_t chunk = digits.size() % DECIMAL_BASE_DIGITS;
+        if (chunk == 0)
+        {
+            chunk = DECIMAL_BASE_DIGITS;
+        }
+        for (size_t start = 0; start < digits.size(); start += chunk, chunk = DECIMAL_BASE_DIGITS)
+        {
+            uint32_t value = 0;
+            uint32_t scale = 1;
+            for (size_t i = start; i < start + chunk; i++)
+            {
+                value = value * 10 + (digits[i] - '0');
+                scale *= 10;
+            }
+            multiplyAddSmall(result, scale, value);
+        }
+        trim(result);
+        return result;
+    }
+    if (digits.size() <= lowDigits)
+    {
+        return parseDecimal(digits, powers, level - 1);
+    }
+
+    Limbs high = parseDecimal(digits.substr(0, digits.size() - lowDigits), powers, level - 1);
+    Limbs low = parseDecimal(digits.substr(digits.size() - lowDigits), powers, level - 1);
+    if (high.empty())
+    {
+        return low;
+    }
+
+    const Limbs &scale = powers[level];
+    Limbs result = multiplyLimbs(high.data(), high.size(), scale.data(), scale.size());
+    result.push_back(0);
+    addAt(result, 0, low);
+    trim(result);
+    return result;
+}
+
+BigInt::BigInt(int64_t value)
+{
+    negative = value < 0;
+    uint64_t absolute = negative ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    while (absolute != 0)
+    {
+        magnitude.push_back(static_cast<uint32_t>(absolute));
+        absolute >>= 32;
+    }
+}
+
+BigInt BigInt::fromDecimal(std::string_view digits)
+{
+    BigInt result;
+
+    if (digits.size() < DECIMAL_SPLIT_THRESHOLD * DECIMAL_BASE_DIGITS)
+    {
+        result.magnitude = parseDecimal(digits, {}, 0);
+        return result;
+    }
+
+    // powers[level] has 9 * 2^level zeros; the top level splits the digits about in half
+    size_t level = 0;
+    while ((DECIMAL_BASE_DIGITS << (level + 1)) < digits.size())
+    {
+        level++;
+    }
+    std::vector<Limbs> powers;
+    while (powers.size() <= level)
+    {
+        pushDecimalPower(powers);
+    }
+
+    result.magnitude = parseDecimal(digits, powers, level);
+    return result;
+}
+
+std::string BigInt::toDecimal() const
+{
+    if (magnitude.empty())
+    {
+        return "0";
+    }
+
+    std::string text = negative ? "-" : "";
+    if (magnitude.size() < DECIMAL_SPLIT_THRESHOLD)
+    {
+        appendDecimalByChunks(magnitude, 0, text);
+        return text;
+    }
+
+    // Stop at the first power at least as large as the value, which is then below the square of
+    // the power before it
+    std::vector<Limbs> powers;
+    do
+    {
+        pushDecimalPower(powers);
+    } while (compareMagnitudes(powers.back(), magnitude) < 0);
+    appendDecimal(magnitude, 0, powers, powers.size() - 2, text);
+    return text;
+}
+
+bool BigInt::fitsInt64() const
+{
+    if (magnitude.size() > 2)
+    {
+        return false;
+    }
+    uint64_t absolute = 0;
+    for (size_t i = magnitude.size(); i-- > 0;)
+    {
+        absolute = (absolute << 32) | magnitude[i];
+    }
+    return absolute <= (negative ? static_cast<uint64_t>(INT64_MAX) + 1 : static_cast<uint64_t>(INT64_MAX));
+}
+
+int64_t BigInt::toInt64() const
+{
+    uint64_t absolute = 0;
+    for (size_t i = magnitude.size(); i-- > 0;)
+    {
+        absolute = (absolute << 32) | magnitude[i];
+    }
+    if (negative)
+    {
+        return -static_cast<int64_t>(absolute - 1) - 1;
+    }
+    return static_cast<int64_t>(absolute);
+}
+
+BigInt BigInt::operator-() const
+{
+    BigInt result = *this;
+    result.negative = !negative && !magnitude.empty();
+    return result;
+}
+
+BigInt operator+(const BigInt &left, const BigInt &right)
+{
+    BigInt result;
+
+    if (left.negative == right.negative)
+    {
+        result.magnitude = addLimbs(left.magnitude.data(), left.magnitude.size(),
+                                    right.magnitude.data(), right.magnitude.size());
+        trim(result.magnitude);
+        result.negative = left.negative && !result.magnitude.empty();
+        return result;
+    }
+
+    // Opposite signs: the result takes the sign of the operand with the larger magnitude
+    int order = compareMagnitudes(left.magnitude, right.magnitude);
+    if (order == 0)
+    {
+        return result;
+    }
+    const BigInt &larger = order > 0 ? left : right;
+    const BigInt &smaller = order > 0 ? right : left;
+    result.magnitude = larger.magnitude;
+    subtractFrom(result.magnitude, smaller.magnitude);
+    trim(result.magnitude);
+    result.negative = larger.negative;
+    return result;
+}
+
+BigInt operator-(const BigInt &left, const BigInt &right)
+{
+    return left + -right;
+}
+
+BigInt operator*(const BigInt &left, const BigInt &right)
+{
+    BigInt result;
+    if (left.magnitude.empty() || right.magnitude.empty())
+    {
+        return result;
+    }
+
+    result.magnitude = multiplyLimbs(left.magnitude.data(), left.magnitude.size(),
+                                     right.magnitude.data(), right.magnitude.size());
+    trim(result.magnitude);
+    result.negative = left.negative != right.negative;
+    return result;
+}
+
+BigInt operator/(const BigInt &dividend, const BigInt &divisor)
+{
+    if (divisor.magnitude.empty())
+    {
+        throw std::runtime_error("Division by zero");
+    }
+
+    BigInt result;
+    result.magnitude = divideMagnitudes(dividend.magnitude, divisor.magnitude);
+    result.negative = dividend.negative != divisor.negative && !result.magnitude.empty();
+    return result;
+}
+
+int BigInt::compare(const BigInt &left, const BigInt &right)
+{
+    if (left.negative != right.negative)
+    {
+        return left.negative ? -1 : 1;
+    }
+    int order = compareMagnitudes(left.magnitude, right.magnitude);
+    return left.negative ? -order : order;
+}
@@ -0,0 +1,98 @@
+#ifndef RPAL_FINAL_BIGINT_H
+#define RPAL_FINAL_BIGINT_H
+
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+/**
+ * @brief An arbitrary-precision integer.
+ *
+ * The magnitude is kept as base 2^32 limbs, least significant first, with no leading zero
+ * limbs, and the sign separately; zero has no limbs and is never negative. Division truncates
+ * toward zero, like the machine's 64-bit integers.
+ */
+class BigInt
+{
+public:
+    /**
+     * Operands with at least this many limbs on both sides are multiplied with Karatsuba's
+     * method; smaller ones use the schoolbook method, which is faster at that size.
+     */
+    static constexpr size_t KARATSUBA_THRESHOLD = 32;
+
+    /**
+     * Values with at least this many limbs are converted to and from decimal by splitting them
+     * in half at a power of ten, recursively. Parsing then costs a few large Karatsuba products.
+     * Printing costs Knuth divisions, which are still quadratic overall but run on
+     * multiply-adds rather than a hardware division per limb. Smaller values take nine digits
+     * per pass over the limbs, which is quadratic too but faster at that size.
+     */
+    static constexpr size_t DECIMAL_SPLIT_THRESHOLD = 64;
+
+    BigInt() = default;
+
+    explicit BigInt(int64_t value);
+
+    /**
+     * @brief Parses a run of decimal digits, with no sign.
+     * @param digits The digits; must not be empty.
+     */
+    static BigInt fromDecimal(std::string_view digits);
+
+    /**
+     * @brief Writes the integer in decimal, with a leading '-' if it is negative.
+     */
+    [[nodiscard]] std::string toDecimal() const;
+
+    [[nodiscard]] bool isZero() const
+    {
+        return magnitude.empty();
+    }
+
+    [[nodiscard]] bool isNegative() const
+    {
+        return negative;
+    }
+
+    /**
+     * @brief Checks whether the integer is within the range of int64_t.
+     */
+    [[nodiscard]] bool fitsInt64() const;
+
+    /**
+     * @brief Returns the integer as an int64_t; it must fit.
+     */
+    [[nodiscard]] int64_t toInt64() const;
+
+    BigInt operator-() const;
+
+    friend BigInt operator+(const BigInt &left, const BigInt &right);
+
+    friend BigInt operator-(const BigInt &left, const BigInt &right);
+
+    friend BigInt operator*(const BigInt &left, const BigInt &right);
+
+    /**
+     * @brief Divides, truncating toward zero.
+     * @throws std::runtime_error if the divisor is zero.
+     */
+    friend BigInt operator/(const BigInt &dividend, const BigInt &divisor);
+
+    /**
+     * @brief Compares two integers.
+     * @return A negative number, zero or a positive number as left is less than, equal to or
+     * greater than right.
+     */
+    static int compare(const BigInt &left, const BigInt &right);
+
+private:
+    bool negative = false;           // Whether the integer is below zero
+    std::vector<uint32_t> magnitude; // Absolute value, least significant limb first
+};
+
+
+#endif //RPAL_FINAL_BIGINT_H
@@ -0,0 +1,659 @@
+#include "Bytecode.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+const char *opcodeName(Opcode op)
+{
+    switch (op)
+    {
+        case Opcode::PUSH_INTEGER: return "PUSH_INTEGER";
+        case Opcode::PUSH_STRING: return "PUSH_STRING";
+        case Opcode::LOAD: return "LOAD";
+        case Opcode::LOAD_GLOBAL: return "LOAD_GLOBAL";
+        case Opcode::UNBOUND: return "UNBOUND";
+        case Opcode::CLOSURE: return "CLOSURE";
+        case Opcode::APPLY: return "APPLY";
+        case Opcode::TUPLE: return "TUPLE";
+        case Opcode::JUMP: return "JUMP";
+        case Opcode::JUMP_IF_FALSE: return "JUMP_IF_FALSE";
+        case Opcode::RETURN: return "RETURN";
+        case Opcode::HALT: return "HALT";
+        case Opcode::ADD: return "ADD";
+        case Opcode::SUBTRACT: return "SUBTRACT";
+        case Opcode::MULTIPLY: return "MULTIPLY";
+        case Opcode::DIVIDE: return "DIVIDE";
+        case Opcode::NEG: return "NEG";
+        case Opcode::NOT: return "NOT";
+        case Opcode::EQ: return "EQ";
+        case Opcode::NE: return "NE";
+        case Opcode::GR: return "GR";
+        case Opcode::GE: return "GE";
+        case Opcode::LS: return "LS";
+        case Opcode::LE: return "LE";
+        case Opcode::OR: return "OR";
+        case Opcode::AND: return "AND";
+        case Opcode::AUG: return "AUG";
+    }
+    return "?";
+}
+
+/**
+ * Maps an operator node to the instruction that applies it.
+ */
+static Opcode operatorOpcode(NodeKind kind)
+{
+    switch (kind)
+    {
+        case NodeKind::PLUS: return Opcode::ADD;
+        case NodeKind::MINUS: return Opcode::SUBTRACT;
+        case NodeKind::TIMES: return Opcode::MULTIPLY;
+        case NodeKind::DIVIDE: return Opcode::DIVIDE;
+        case NodeKind::NEG: return Opcode::NEG;
+        case NodeKind::NOT: return Opcode::NOT;
+        case NodeKind::EQ: return Opcode::EQ;
+        case NodeKind::NE: return Opcode::NE;
+        case NodeKind::GR: return Opcode::GR;
+        case NodeKind::GE: return Opcode::GE;
+        case NodeKind::LS: return Opcode::LS;
+        case NodeKind::LE: return Opcode::LE;
+        case NodeKind::OR: return Opcode::OR;
+        case NodeKind::AMP: return Opcode::AND;
+        case NodeKind::AUG: return Opcode::AUG;
+        default: throw std::runtime_error("Invalid operator: " + std::string(nodeKindLabel(kind)));
+    }
+}
+
+namespace
+{
+    /**
+     * An instruction before it is encoded. A conditional is kept as JUMP_IF_FALSE with the
+     * lists of its two arms as operands until the arms are inlined.
+     */
+    struct PendingInstruction
+    {
+        Opcode op;
+        uint32_t operand;
+        uint32_t operand2;
+    };
+
+    /**
+     * Builds the pools and blocks of a Program from an ST.
+     */
+    class Compiler
+    {
+    public:
+        Program program;
+
+        void compile(TreeNode *root)
+        {
+            emit(newList(), Opcode::HALT);
+
+            // An entry that leaves a scope marks where the body of the lambda numbered block ends,
+            // so its variables go out of scope
+            struct Pending
+            {
+                TreeNode *node;
+                uint32_t block;
+                bool leavesScope = false;
+            };
+            std::vector<Pending> pending;
+
+            // An empty or comment-only program has no tree and compiles to the HALT alone
+            if (root != nullptr)
+            {
+                pending.push_back({root, 0});
+            }
+
+            // Every lambda body and conditional arm gets a list of its own, numbered in the order a
+            // depth-first walk reaches them, as the textbook machine numbers control structures.
+            // Each node appends its own instruction before those of its children and each list is
+            // reversed when it is encoded, so children run first, right to left
+            while (!pending.empty())
+            {
+                auto [node, block, leavesScope] = pending.back();
+                pending.pop_back();
+
+                if (leavesScope)
+                {
+                    leaveScope(program.lambdas[block]);
+                    continue;
+                }
+                if (node == nullptr)
+                {
+                    throw std::runtime_error("Invalid tree: a node is missing an operand");
+                }
+
+                NodeKind kind = node->getKind();
+                size_t firstChild = pending.size();
+
+                if (kind == NodeKind::LAMBDA)
+                {
+                    TreeNode *bound = node->getChild(0);
+                    uint32_t body = newList();
+                    emit(body, Opcode::RETURN);
+
+                    // The body's block is filled in when the lists are encoded
+                    Lambda lambda{0, body, static_cast<uint32_t>(program.variables.size()), 0, false};
+                    if (bound->getKind() == NodeKind::COMMA)
+                    {
+                        lambda.tuple = true;
+                        for (TreeNode *variable : bound->getChildren())
+                        {
+                            program.variables.push_back(variable->getSymbol());
+                        }
+                    }
+                    else
+                    {
+                        program.variables.push_back(bound->getSymbol());
+                    }
+                    lambda.variableCount = static_cast<uint32_t>(program.variables.size()) - lambda.firstVariable;
+
+                    emit(block, Opcode::CLOSURE, static_cast<uint32_t>(program.lambdas.size()));
+                    enterScope(lambda);
+                    pending.push_back({nullptr, static_cast<uint32_t>(program.lambdas.size()), true});
+                    pending.push_back({bound->getNextSibling(), body});
+                    program.lambdas.push_back(lambda);
+                    continue;
+                }
+
+                if (kind == NodeKind::CONDITIONAL)
+                {
+                    TreeNode *condition = node->getChild(0);
+                    TreeNode *thenBranch = condition->getNextSibling();
+                    TreeNode *elseBranch = thenBranch->getNextSibling();
+
+                    uint32_t thenList = newList();
+                    uint32_t elseList = newList();
+                    emit(block, Opcode::JUMP_IF_FALSE, thenList, elseList);
+
+                    pending.push_back({condition, block});
+                    pending.push_back({elseBranch, elseList});
+                    pending.push_back({thenBranch, thenList});
+                    continue;
+                }
+
+                if (kind == NodeKind::TAU)
+                {
+                    emit(block, Opcode::TUPLE, node->getNumChildren());
+                }
+                else if (kind == NodeKind::GAMMA)
+                {
+                    emit(block, Opcode::APPLY);
+                }
+                else if (isOperatorKind(kind))
+                {
+                    emit(block, operatorOpcode(kind));
+                }
+                else if (kind == NodeKind::IDENTIFIER)
+                {
+                    std::optional<Binding> binding = resolve(node->getSymbol());
+                    if (binding && binding->depth == 0)
+                    {
+                        emit(block, Opcode::LOAD_GLOBAL, binding->slot);
+                    }
+                    else if (binding)
+                    {
+                        emit(block, Opcode::LOAD, depth - binding->depth, binding->slot);
+                    }
+                    else
+                    {
+                        emit(block, Opcode::UNBOUND, symbol(node->getSymbol()));
+                    }
+                }
+                else if (kind == NodeKind::INTEGER)
+                {
+                    emit(block, Opcode::PUSH_INTEGER, integerConstant(node->getValue()));
+                }
+                else if (kind == NodeKind::STRING)
+                {
+                    emit(block, Opcode::PUSH_STRING, stringConstant(node->getValue()));
+                }
+                else
+                {
+                    throw std::runtime_error("Invalid node type: " + std::string(node->getLabel()) +
+                                             "Value: " + std::string(node->getValue()));
+                }
+
+                for (TreeNode *child : node->getChildren())
+                {
+                    pending.push_back({child, block});
+                }
+                std::reverse(pending.begin() + static_cast<std::ptrdiff_t>(firstChild), pending.end());
+            }
+
+            encode();
+        }
+
+    private:
+        /**
+         * Where a variable in scope lives: the number of lambdas around it, counting its own,
+         * and its slot in that lambda's environment. Depth 0 is the global environment.
+         */
+        struct Binding
+        {
+            uint32_t depth;
+            uint32_t slot;
+        };
+
+        std::vector<std::vector<PendingInstruction>> lists;
+        std::unordered_map<std::string_view, uint32_t> stringIndices; // Views of string literals in the tree's arena
+        std::unordered_map<symbol_id, uint32_t> symbolIndices;
+        std::unordered_map<symbol_id, std::vector<Binding>> visible; // Variables in scope, innermost last
+        uint32_t depth = 0;                                          // Number of lambdas around the node being compiled
+
+        /**
+         * Finds what an identifier names: the innermost lambda variable of that name, or else
+         * the global environment's slot for a built-in function or nil.
+         */
+        [[nodiscard]] std::optional<Binding> resolve(symbol_id identifier) const
+        {
+            auto it = visible.find(identifier);
+            if (it != visible.end() && !it->second.empty())
+            {
+                return it->second.back();
+            }
+            if (identifier < GLOBAL_SLOT_COUNT)
+            {
+                return Binding{0, identifier};
+            }
+            return std::nullopt;
+        }
+
+        void enterScope(const Lambda &lambda)
+        {
+            depth++;
+            for (uint32_t slot = 0; slot < lambda.variableCount; ++slot)
+            {
+                symbol_id variable = program.variables[lambda.firstVariable + slot];
+                if (variable != NO_SYMBOL)
+                {
+                    visible[variable].push_back({depth, slot});
+                }
+            }
+        }
+
+        void leaveScope(const Lambda &lambda)
+        {
+            for (uint32_t slot = 0; slot < lambda.variableCount; ++slot)
+            {
+                symbol_id variable = program.variables[lambda.firstVariable + slot];
+                if (variable != NO_SYMBOL)
+                {
+                    visible[variable].pop_back();
+                }
+            }
+            depth--;
+        }
+
+        uint32_t newList()
+        {
+            lists.emplace_back();
+            return static_cast<uint32_t>(lists.size() - 1);
+        }
+
+        void emit(uint32_t list, Opcode op, uint32_t operand = 0, uint32_t operand2 = 0)
+        {
+            lists[list].push_back({op, operand, operand2});
+        }
+
+        // Integer literals are not deduplicated: the machine decodes each constant once before it
+        // runs anyway, and looking every literal up would cost more than the copies it saves
+        uint32_t integerConstant(std::string_view value)
+        {
+            program.constants.emplace_back(value);
+            return static_cast<uint32_t>(program.constants.size() - 1);
+        }
+
+        // The literal's text stays in the tree's arena until compiling is done, so the pool can be
+        // keyed on views of it and each distinct string is copied only once, into the program
+        uint32_t stringConstant(std::string_view value)
+        {
+            auto [it, inserted] = stringIndices.try_emplace(value, static_cast<uint32_t>(program.constants.size()));
+            if (inserted)
+            {
+                program.constants.emplace_back(value);
+            }
+            return it->second;
+        }
+
+        uint32_t symbol(symbol_id id)
+        {
+            auto [it, inserted] = symbolIndices.try_emplace(id, static_cast<uint32_t>(program.symbols.size()));
+            if (inserted)
+            {
+                program.symbols.push_back(id);
+            }
+            return it->second;
+        }
+
+        static void write(std::vector<uint8_t> &code, Opcode op, uint32_t operand = 0, uint32_t operand2 = 0)
+        {
+            code.push_back(static_cast<uint8_t>(op));
+            uint32_t operands[] = {operand, operand2};
+            for (int i = 0; i < operandCount(op); ++i)
+            {
+                size_t at = code.size();
+                code.resize(at + sizeof(uint32_t));
+                std::memcpy(code.data() + at, &operands[i], sizeof(uint32_t));
+            }
+        }
+
+        static void patch(std::vector<uint8_t> &code, size_t jump)
+        {
+            auto target = static_cast<uint32_t>(code.size());
+            std::memcpy(code.data() + jump + 1, &target, sizeof(uint32_t));
+        }
+
+        /**
+         * Encodes the program and the lambda bodies into blocks, inlining conditional arms as
+         *     condition  JUMP_IF_FALSE else  then-arm  JUMP end  else: else-arm  end:
+         */
+        void encode()
+        {
+            program.blocks.resize(program.lambdas.size() + 1);
+            for (uint32_t i = 0; i < program.lambdas.size(); ++i)
+            {
+                program.lambdas[i].body = i + 1;
+            }
+
+            enum Role : uint8_t
+            {
+                BLOCK,
+                THEN_ARM,
+                ELSE_ARM
+            };
+
+            struct Cursor
+            {
+                uint32_t list;     // The list being encoded
+                size_t next;       // How many of its instructions are encoded, counting from its end
+                Role role;
+                size_t jump;       // The jump to patch once an arm is encoded
+                uint32_t elseList; // The list to encode after a then-arm
+            };
+
+            for (uint32_t b = 0; b < program.blocks.size(); ++b)
+            {
+                std::vector<uint8_t> &code = program.blocks[b];
+                std::vector<Cursor> cursors = {{b == 0 ? 0 : program.lambdas[b - 1].number, 0, BLOCK, 0, 0}};
+
+                while (!cursors.empty())
+                {
+                    Cursor cursor = cursors.back();
+                    const std::vector<PendingInstruction> &list = lists[cursor.list];
+
+                    if (cursor.next == list.size())
+                    {
+                        cursors.pop_back();
+                        if (cursor.role == THEN_ARM)
+                        {
+                            size_t jump = code.size();
+                            write(code, Opcode::JUMP);
+                            patch(code, cursor.jump);
+                            cursors.push_back({cursor.elseList, 0, ELSE_ARM, jump, 0});
+                        }
+                        else if (cursor.role == ELSE_ARM)
+                        {
+                            patch(code, cursor.jump);
+                        }
+                        continue;
+                    }
+
+                    const PendingInstruction &instruction = list[list.size() - 1 - cursor.next];
+                    cursors.back().next++;
+
+                    if (instruction.op == Opcode::JUMP_IF_FALSE)
+                    {
+                        size_t jump = code.size();
+                        write(code, Opcode::JUMP_IF_FALSE);
+                        cursors.push_back({instruction.operand, 0, THEN_ARM, jump, instruction.operand2});
+                    }
+                    else
+                    {
+                        write(code, instruction.op, instruction.operand, instruction.operand2);
+                    }
+                }
+            }
+        }
+    };
+}
+
+Program compileProgram(TreeNode *root)
+{
+    Compiler compiler;
+    compiler.compile(root);
+    return std::move(compiler.program);
+}
+
+/**
+ * Marks the offsets where instructions of a block start; fails if an opcode is unknown or an
+ * instruction runs past the end of the block.
+ */
+static bool instructionStarts(const std::vector<uint8_t> &code, std::vector<bool> &starts)
+{
+    starts.assign(code.size(), false);
+    for (size_t pc = 0; pc < code.size(); pc += instructionLength(static_cast<Opcode>(code[pc])))
+    {
+        if (code[pc] >= OPCODE_COUNT || pc + instructionLength(static_cast<Opcode>(code[pc])) > code.size())
+        {
+            return false;
+        }
+        starts[pc] = true;
+    }
+    return true;
+}
+
+bool verifyProgram(const Program &program)
+{
+    if (program.blocks.size() != program.lambdas.size() + 1)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < program.lambdas.size(); ++i)
+    {
+        const Lambda &lambda = program.lambdas[i];
+        if (lambda.body != i + 1 ||
+            lambda.firstVariable > program.variables.size() ||
+            lambda.variableCount > program.variables.size() - lambda.firstVariable ||
+            (!lambda.tuple && lambda.variableCount != 1))
+        {
+            return false;
+        }
+    }
+
+    // The block each lambda's closures are made in, and how many lambdas enclose each block.
+    // A lambda's closures can only be made in an earlier block, so blocks are checked in order
+    constexpr uint32_t NO_PARENT = UINT32_MAX;
+    std::vector<uint32_t> parents(program.lambdas.size(), NO_PARENT);
+    std::vector<uint32_t> depths(program.blocks.size(), 0);
+
+    std::vector<bool> starts;
+    for (size_t b = 0; b < program.blocks.size(); ++b)
+    {
+        const std::vector<uint8_t> &code = program.blocks[b];
+        if (!instructionStarts(code, starts))
+        {
+            return false;
+        }
+
+        // A lambda that no block makes closures of never runs; its body is only checked
+        // against its own variables
+        if (b > 0)
+        {
+            uint32_t parent = parents[b - 1];
+            depths[b] = parent == NO_PARENT ? 1 : depths[parent] + 1;
+        }
+
+        Opcode terminator = b == 0 ? Opcode::HALT : Opcode::RETURN;
+        for (size_t pc = 0; pc < code.size(); pc += instructionLength(static_cast<Opcode>(code[pc])))
+        {
+            auto op = static_cast<Opcode>(code[pc]);
+            bool last = pc + instructionLength(op) == code.size();
+            uint32_t operand = operandCount(op) > 0 ? readOperand(&code[pc + 1]) : 0;
+
+            switch (op)
+            {
+                case Opcode::PUSH_INTEGER:
+                case Opcode::PUSH_STRING:
+                    if (operand >= program.constants.size())
+                        return false;
+                    break;
+                case Opcode::LOAD:
+                {
+                    uint32_t slot = readOperand(&code[pc + 1 + sizeof(uint32_t)]);
+                    if (operand >= depths[b])
+                        return false;
+                    size_t enclosing = b;
+                    for (uint32_t level = 0; level < operand; ++level)
+                        enclosing = parents[enclosing - 1];
+                    if (slot >= program.lambdas[enclosing - 1].variableCount)
+                        return false;
+                    break;
+                }
+                case Opcode::LOAD_GLOBAL:
+                    if (operand >= GLOBAL_SLOT_COUNT)
+                        return false;
+                    break;
+                case Opcode::UNBOUND:
+                    if (operand >= program.symbols.size())
+                        return false;
+                    break;
+                case Opcode::CLOSURE:
+                    if (operand >= program.lambdas.size() || operand < b ||
+                        (parents[operand] != NO_PARENT && parents[operand] != b))
+                        return false;
+                    parents[operand] = static_cast<uint32_t>(b);
+                    break;
+                case Opcode::JUMP:
+                case Opcode::JUMP_IF_FALSE:
+                    if (operand <= pc || operand >= code.size() || !starts[operand])
+                        return false;
+                    break;
+                case Opcode::HALT:
+                case Opcode::RETURN:
+                    if (op != terminator || !last)
+                        return false;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        if (code.empty() || code.back() != static_cast<uint8_t>(terminator))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void disassemble(const Program &program, std::ostream &out)
+{
+    const SymbolTable &symbols = SymbolTable::getInstance();
+
+    // The block each lambda's closures are made in, to name the variables LOAD reads
+    std::vector<size_t> parents(program.lambdas.size(), 0);
+    for (size_t b = 0; b < program.blocks.size(); ++b)
+    {
+        const std::vector<uint8_t> &code = program.blocks[b];
+        for (size_t pc = 0; pc < code.size() && code[pc] < OPCODE_COUNT &&
+                            pc + instructionLength(static_cast<Opcode>(code[pc])) <= code.size();
+             pc += instructionLength(static_cast<Opcode>(code[pc])))
+        {
+            uint32_t operand = operandCount(static_cast<Opcode>(code[pc])) > 0 ? readOperand(&code[pc + 1]) : 0;
+            if (static_cast<Opcode>(code[pc]) == Opcode::CLOSURE && operand < parents.size())
+                parents[operand] = b;
+        }
+    }
+
+    auto loaded = [&](size_t block, uint32_t depth, uint32_t slot) -> std::string {
+        for (; depth > 0 && block > 0; --depth)
+            block = parents[block - 1];
+        if (block == 0 || block - 1 >= program.lambdas.size() || slot >= program.lambdas[block - 1].variableCount)
+            return "?";
+        symbol_id variable = program.variables[program.lambdas[block - 1].firstVariable + slot];
+        return variable == NO_SYMBOL ? "()" : symbols.name(variable);
+    };
+
+    auto variables = [&](const Lambda &lambda) {
+        std::string names;
+        for (uint32_t i = 0; i < lambda.variableCount && lambda.firstVariable + i < program.variables.size(); ++i)
+        {
+            symbol_id variable = program.variables[lambda.firstVariable + i];
+            names += (i > 0 ? ", " : "") + (variable == NO_SYMBOL ? "()" : symbols.name(variable));
+        }
+        return lambda.tuple ? "(" + names + ")" : names;
+    };
+
+    for (size_t b = 0; b < program.blocks.size(); ++b)
+    {
+        out << "block " << b;
+        if (b == 0)
+            out << " (program)";
+        else if (b - 1 < program.lambdas.size())
+            out << " (lambda " << variables(program.lambdas[b - 1]) << ")";
+        out << ":\n";
+
+        const std::vector<uint8_t> &code = program.blocks[b];
+        for (size_t pc = 0; pc < code.size();)
+        {
+            out << std::setw(8) << pc << "  ";
+            if (code[pc] >= OPCODE_COUNT || pc + instructionLength(static_cast<Opcode>(code[pc])) > code.size())
+            {
+                out << "<invalid " << static_cast<int>(code[pc]) << ">\n";
+                break;
+            }
+
+            auto op = static_cast<Opcode>(code[pc]);
+            if (operandCount(op) == 0)
+            {
+                out << opcodeName(op) << "\n";
+                pc += instructionLength(op);
+                continue;
+            }
+            out << std::left << std::setw(14) << opcodeName(op) << std::right;
+
+            uint32_t operand = readOperand(&code[pc + 1]);
+            out << operand;
+            if (operandCount(op) > 1)
+                out << " " << readOperand(&code[pc + 1 + sizeof(uint32_t)]);
+            switch (op)
+            {
+                case Opcode::PUSH_INTEGER:
+                    if (operand < program.constants.size())
+                        out << "  ; " << program.constants[operand];
+                    break;
+                case Opcode::PUSH_STRING:
+                    if (operand < program.constants.size())
+                        out << "  ; '" << program.constants[operand] << "'";
+                    break;
+                case Opcode::LOAD:
+                    out << "  ; " << loaded(b, operand, readOperand(&code[pc + 1 + sizeof(uint32_t)]));
+                    break;
+                case Opcode::LOAD_GLOBAL:
+                    if (operand < GLOBAL_SLOT_COUNT)
+                        out << "  ; " << symbols.name(operand);
+                    break;
+                case Opcode::UNBOUND:
+                    if (operand < program.symbols.size())
+                        out << "  ; " << symbols.name(program.symbols[operand]);
+                    break;
+                case Opcode::CLOSURE:
+                    if (operand < program.lambdas.size())
+                        out << "  ; lambda " << variables(program.lambdas[operand]) << " -> block "
+                            << program.lambdas[operand].body << ", shown as " << program.lambdas[operand].number;
+                    break;
+                default:
+                    break;
+            }
+            out << "\n";
+            pc += instructionLength(op);
+        }
+    }
+}
@@ -0,0 +1,186 @@
+#ifndef RPAL_FINAL_BYTECODE_H
+#define RPAL_FINAL_BYTECODE_H
+
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "SymbolTable.h"
+#include "TreeNode.h"
+
+
+/**
+ * @brief The instructions of the CSE machine.
+ *
+ * Every instruction is a one-byte opcode followed by zero, one or two 32-bit operands in
+ * native byte order. Operands are indices into the pools of the Program, jump targets (byte
+ * offsets within the same block), counts, or environment depths and slots, as noted for each
+ * opcode.
+ */
+enum class Opcode : uint8_t
+{
+    PUSH_INTEGER,   // constant: push an integer
+    PUSH_STRING,    // constant: push a string
+    LOAD,           // depth, slot: push the value in a slot of the environment depth levels out
+    LOAD_GLOBAL,    // slot: push the built-in function or nil in a slot of the global environment
+    UNBOUND,        // symbol: fail, because nothing binds the identifier
+    CLOSURE,        // lambda: push a closure over the current environment
+    APPLY,          // gamma: apply the value on top of the stack to the one under it
+    TUPLE,          // count: collect that many values into a tuple
+    JUMP,           // target: continue at the target
+    JUMP_IF_FALSE,  // target: pop a truth value and continue at the target if it is false
+    RETURN,         // leave a lambda body and restore the caller's environment
+    HALT,           // end of the program
+    ADD,
+    SUBTRACT,
+    MULTIPLY,
+    DIVIDE,
+    NEG,
+    NOT,
+    EQ,
+    NE,
+    GR,
+    GE,
+    LS,
+    LE,
+    OR,
+    AND,
+    AUG
+};
+
+constexpr int OPCODE_COUNT = static_cast<int>(Opcode::AUG) + 1;
+
+/**
+ * @brief Returns how many 32-bit operands follow an opcode.
+ */
+constexpr int operandCount(Opcode op)
+{
+    switch (op)
+    {
+        case Opcode::LOAD:
+            return 2;
+        case Opcode::PUSH_INTEGER:
+        case Opcode::PUSH_STRING:
+        case Opcode::LOAD_GLOBAL:
+        case Opcode::UNBOUND:
+        case Opcode::CLOSURE:
+        case Opcode::TUPLE:
+        case Opcode::JUMP:
+        case Opcode::JUMP_IF_FALSE:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Returns the number of bytes an instruction with the given opcode takes.
+ */
+constexpr size_t instructionLength(Opcode op)
+{
+    return 1 + operandCount(op) * sizeof(uint32_t);
+}
+
+/**
+ * @brief Reads the 32-bit operand starting at the given byte.
+ */
+inline uint32_t readOperand(const uint8_t *bytes)
+{
+    uint32_t operand;
+    std::memcpy(&operand, bytes, sizeof(operand));
+    return operand;
+}
+
+/**
+ * @brief Returns the mnemonic the disassembler prints for an opcode.
+ */
+const char *opcodeName(Opcode op);
+
+/**
+ * Number of slots in the global environment, the one around the whole program. It binds each
+ * built-in function to the slot of its symbol ID, and nil to the slot after them.
+ */
+constexpr uint32_t GLOBAL_SLOT_COUNT = SYM_NIL + 1;
+
+/**
+ * @brief What a lambda binds when it is applied.
+ *
+ * The bound variables are variables[firstVariable, firstVariable + variableCount) of the
+ * Program. A lambda over a tuple of variables (fn (x, y). ...) unpacks its argument into
+ * them; otherwise it has exactly one variable, which is NO_SYMBOL for fn (). ... Applying the
+ * lambda makes an environment with one slot per variable, in this order, which is where LOAD
+ * finds them.
+ *
+ * The number is the index the textbook CSE machine gives the lambda's control structure,
+ * counting conditional arms as control structures of their own; Print shows it for closures.
+ */
+struct Lambda
+{
+    uint32_t body;          // The block that holds the body
+    uint32_t number;        // The control structure number shown when a closure is printed
+    uint32_t firstVariable; // Index of the first bound variable in Program::variables
+    uint32_t variableCount; // Number of bound variables
+    bool tuple;             // Whether the argument is unpacked into the variables
+};
+
+/**
+ * @brief A compiled RPAL program.
+ *
+ * The program itself and every lambda body are each one block: a contiguous array of
+ * instructions that runs front to back, with the arms of conditionals inlined behind jumps.
+ * Block 0 is the program and ends with HALT; block i + 1 is the body of lambda i and ends
+ * with RETURN.
+ */
+struct Program
+{
+    std::vector<std::vector<uint8_t>> blocks; // Instructions of the program and of each lambda body
+    std::vector<std::string> constants;       // Integer and string literals
+    std::vector<symbol_id> symbols;           // Identifiers named by UNBOUND
+    std::vector<Lambda> lambdas;              // Lambdas named by CLOSURE
+    std::vector<symbol_id> variables;         // Bound variables of every lambda
+};
+
+/**
+ * @brief Compiles a standardized tree into bytecode.
+ *
+ * The tree is walked without recursion, so arbitrarily deep programs compile. Operands are
+ * evaluated right to left, as in the textbook CSE machine, and lambdas are numbered in the
+ * order a depth-first walk meets them. Each identifier is resolved to the innermost lambda
+ * variable of that name, as a LOAD of the environment that many lambdas out and the slot in
+ * it, or else to the built-in function or nil it names, as a LOAD_GLOBAL; any other identifier
+ * becomes UNBOUND.
+ *
+ * @param root The root of the ST, or nullptr for an empty program, which compiles to a lone HALT.
+ * @return The compiled program.
+ * @throws std::runtime_error if the tree contains a node the machine cannot run, or lacks an operand.
+ */
+Program compileProgram(TreeNode *root);
+
+/**
+ * @brief Checks that every instruction of a program is well formed.
+ *
+ * Opcodes must be known, instructions must not run past the end of their block, pool
+ * indices must be in range, jumps must go forward to an instruction of their own block, and each
+ * block must end with its only terminator: HALT for the program and RETURN for lambda i's
+ * body, block i + 1. Each lambda's closures must be made in one block only, the program or an
+ * earlier lambda's body, so that environments nest as the blocks do, and every LOAD must name
+ * a slot of a lambda enclosing its block. Programs from compileProgram() always pass; this
+ * guards programs that were read back from somewhere else.
+ *
+ * @param program The program to check.
+ * @return True if the program is well formed.
+ */
+bool verifyProgram(const Program &program);
+
+/**
+ * @brief Writes a readable listing of a program, one instruction per line.
+ * @param program The program to list.
+ * @param out The stream to write to.
+ */
+void disassemble(const Program &program, std::ostream &out);
+
+
+#endif //RPAL_FINAL_BYTECODE_H
@@ -4,880 +4,574 @@
 
 #include "CSE.h"
 
-#pragma clang diagnostic push
-#pragma ide diagnostic ignored "OCDFAInspection"
-
-
-std::vector<std::string> built_in_functions = {"Print", "Order", "Y*", "Conc", "Stem", "Stern", "Isinteger", "Isstring",
-                                               "Istuple", "Isempty", "ItoS"};
+#include <algorithm>
+#include <cctype>
 
 
 /*
- * CseNode class
+ * Stack class
  */
-CseNode::CseNode(ObjType node_type, std::string node_value, int cs_index, int env) {
-    this->node_type = node_type;
-    this->node_value = std::move(node_value);
-    this->cs_index = cs_index;
-    this->env = env;
-}
-
-#pragma clang diagnostic pop
-
-CseNode::CseNode(ObjType node_type, std::string node_value, int cs_index) {
-    this->node_type = node_type;
-    this->node_value = std::move(node_value);
-    this->cs_index = cs_index;
-}
-
-CseNode::CseNode(ObjType node_type, std::string node_value) {
-    this->node_type = node_type;
-    this->node_value = std::move(node_value);
-}
-
-CseNode::CseNode(ObjType node_type, int cs_index, std::vector<std::string> bound_variables) {
-    is_single_bound_var = false;
-    this->node_type = node_type;
-    this->cs_index = cs_index;
-    this->bound_variables = std::move(bound_variables);
-}
-
-CseNode::CseNode(ObjType node_type, int cs_index, std::vector<std::string> bound_variables, int env) {
-    is_single_bound_var = false;
-    this->node_type = node_type;
-    this->node_value = std::move(node_value);
-    this->cs_index = cs_index;
-    this->env = env;
-    this->bound_variables = std::move(bound_variables);
-}
-
-CseNode::CseNode(ObjType node_type, std::vector<CseNode> list_elements) {
-    this->node_type = node_type;
-    this->list_elements = std::move(list_elements);
-}
-
-ObjType CseNode::get_node_type() const {
-    return node_type;
+void Stack::push(Value value) {
+    values.push_back(std::move(value));
 }
 
-std::string CseNode::get_node_value() const {
-    return node_value;
-}
-
-int CseNode::get_env() const {
-    return env;
-}
-
-int CseNode::get_cs_index() const {
-    return cs_index;
-}
+Value Stack::pop() {
+    if (values.empty()) {
+        throw std::runtime_error("Stack underflow");
+    }
 
-bool CseNode::get_is_single_bound_var() const {
-    return is_single_bound_var;
-}
+    Value value = std::move(values.back());
+    values.pop_back();
 
-std::vector<std::string> CseNode::get_var_list() const {
-    return bound_variables;
+    return value;
 }
 
-std::vector<CseNode> CseNode::get_list_elements() {
-    return list_elements;
-}
-
-CseNode CseNode::set_env(int env_) {
-    this->env = env_;
-    return *this;
-}
+const Value &Stack::peek() const {
+    if (values.empty()) {
+        throw std::runtime_error("Stack underflow");
+    }
 
-/*
- * ControlStructure class
- */
-ControlStructure::ControlStructure(int cs_index) {
-    this->cs_index = cs_index;
+    return values.back();
 }
 
-void ControlStructure::add_node(const CseNode &node) {
-    nodes.push_back(node);
+int Stack::length() const {
+    return static_cast<int>(values.size());
 }
 
-[[maybe_unused]] int ControlStructure::get_cs_index() const {
-    return cs_index;
+// the offset of the instruction that runs next from pc, following unconditional jumps
+static uint32_t skip_jumps(const uint8_t *code, uint32_t pc) {
+    while (static_cast<Opcode>(code[pc]) == Opcode::JUMP) {
+        pc = readOperand(code + pc + 1);
+    }
+    return pc;
 }
 
-[[maybe_unused]] CseNode ControlStructure::get_last_node() const {
-    return nodes.back();
+void CSE::create_cs(TreeNode *root) {
+    program = compileProgram(root);
 }
 
-void ControlStructure::pop_last_node() {
-    nodes.pop_back();
+const Program &CSE::get_program() const {
+    return program;
 }
 
-CseNode ControlStructure::pop_and_return_last_node() {
-    CseNode node = nodes.back();
-    nodes.pop_back();
-
-    return node;
+void CSE::set_program(Program compiled) {
+    program = std::move(compiled);
 }
 
-void ControlStructure::push_control_structure(const ControlStructure &cs) {
-    for (auto &node: cs.nodes) {
-        nodes.push_back(node);
+// reads an integer the way std::stoll does: leading whitespace, a sign, then digits up to the
+// first character that is not one, but with no limit on the number of digits
+static Value parse_integer(const std::string &text) {
+    size_t start = 0;
+    while (start < text.size() && std::isspace(static_cast<unsigned char>(text[start]))) {
+        start++;
     }
-}
-
-void Stack::add_node(const CseNode &node) {
-    nodes.push_back(node);
-}
 
-[[maybe_unused]] void Stack::pop_last_node() {
-    nodes.pop_back();
-}
+    bool negative = start < text.size() && text[start] == '-';
+    if (start < text.size() && (text[start] == '-' || text[start] == '+')) {
+        start++;
+    }
 
-CseNode Stack::pop_and_return_last_node() {
-    CseNode node = nodes.back();
-    nodes.pop_back();
+    size_t end = start;
+    while (end < text.size() && std::isdigit(static_cast<unsigned char>(text[end]))) {
+        end++;
+    }
+    if (end == start) {
+        throw std::invalid_argument("stoll");
+    }
 
-    return node;
-}
+    // up to 18 digits always fit in 64 bits
+    if (end - start <= 18) {
+        int64_t value = 0;
+        for (size_t i = start; i < end; i++) {
+            value = value * 10 + (text[i] - '0');
+        }
+        return Value::integer(negative ? -value : value);
+    }
 
-[[maybe_unused]] int Stack::length() const {
-    return static_cast<int>(nodes.size());
+    BigInt value = BigInt::fromDecimal(std::string_view(text).substr(start, end - start));
+    return Value::integer(negative ? -value : value);
+}
+
+symbol_id CSE::bound_symbol(const Value &closure) const {
+    const Lambda &lambda = program.lambdas[closure.lambda()];
+    return lambda.tuple ? NO_SYMBOL : program.variables[lambda.firstVariable];
+}
+
+// identifiers and single variable closures stand for their name, tuples for the empty string
+std::string CSE::value_text(const Value &value) const {
+    switch (value.kind()) {
+        case ValueKind::INTEGER:
+            return std::to_string(value.asInteger());
+        case ValueKind::BIG_INTEGER:
+            return value.asBigInt().toDecimal();
+        case ValueKind::BOOLEAN:
+            return value.asBoolean() ? "true" : "false";
+        case ValueKind::STRING:
+            return std::string(value.asString());
+        case ValueKind::TUPLE:
+            return "";
+        case ValueKind::CLOSURE:
+        case ValueKind::EETA:
+            return SymbolTable::getInstance().name(bound_symbol(value));
+        case ValueKind::BUILTIN:
+            return SymbolTable::getInstance().name(value.asBuiltin());
+        case ValueKind::ENV:
+            return std::to_string(value.env()->number());
+    }
+    return "";
 }
 
-/*
- * Env class
- */
-Env::Env() {
-    parent_env = nullptr;
+BigInt CSE::integer_of(const Value &value) const {
+    if (value.isInteger()) {
+        return value.asBigInt();
+    }
+    return parse_integer(value_text(value)).asBigInt();
 }
 
-Env::Env(Env *parent_env) {
-    this->parent_env = parent_env;
+bool CSE::is_true(const Value &value) const {
+    if (value.kind() == ValueKind::BOOLEAN) {
+        return value.asBoolean();
+    }
+    return value.kind() == ValueKind::STRING && value.asString() == "true";
 }
 
-void Env::add_variable(const std::string &identifier, const CseNode &value) {
-    variables[identifier] = value;
-}
+void CSE::print_value(const Value &value) {
+    if (value.kind() == ValueKind::TUPLE) {
+        // nested tuples are written from an explicit stack of (tuple, next element) pairs
+        std::vector<std::pair<const Tuple *, uint32_t>> tuples = {{&value.asTuple(), 0}};
+        out << "(";
 
-[[maybe_unused]] void Env::add_variables(const std::vector<std::string> &identifiers,
-                                         const std::vector<CseNode> &values) {
-    for (int i = 0; i < identifiers.size(); i++) {
-        variables[identifiers[i]] = values[i];
-    }
-}
+        while (!tuples.empty()) {
+            auto &[tuple, next] = tuples.back();
 
-void Env::add_list(const std::string &identifier, const std::vector<CseNode> &list_elements) {
-    lists[identifier] = list_elements;
-}
+            if (next == tuple->size()) {
+                tuples.pop_back();
+                out << ")";
+                continue;
+            }
 
-void Env::add_lambda(const std::string &identifier, const CseNode &lambda) {
-    is_lambda = true;
+            if (next > 0) {
+                out << ", ";
+            }
 
-    // check the node type and create new object
-    if (lambda.get_node_type() == ObjType::LAMBDA) {
-        if (lambda.get_is_single_bound_var()) {
-            lambdas[identifier] = CseNode(ObjType::LAMBDA,
-                                          lambda.get_node_value(), lambda.get_cs_index(), lambda.get_env());
-        } else {
-            lambdas[identifier] = CseNode(ObjType::LAMBDA, lambda.get_cs_index(),
-                                          lambda.get_var_list(), lambda.get_env());
-        }
-    } else if (lambda.get_node_type() == ObjType::EETA) {
-        if (lambda.get_is_single_bound_var()) {
-            lambdas[identifier] = CseNode(ObjType::EETA,
-                                          lambda.get_node_value(), lambda.get_cs_index(), lambda.get_env());
-        } else {
-            lambdas[identifier] = CseNode(ObjType::EETA, lambda.get_cs_index(),
-                                          lambda.get_var_list(), lambda.get_env());
+            const Value &element = (*tuple)[next++];
+            if (element.kind() == ValueKind::TUPLE) {
+                out << "(";
+                tuples.emplace_back(&element.asTuple(), 0);
+            } else if (element.kind() == ValueKind::STRING) {
+                out << element.asString();
+            } else {
+                out << value_text(element);
+            }
         }
+    } else if (value.kind() == ValueKind::ENV ||
+               (value.kind() == ValueKind::STRING && value.asString() == "dummy")) {
+        out << "dummy";
+    } else if (value.kind() == ValueKind::CLOSURE) {
+        out << "[lambda closure: ";
+        out << SymbolTable::getInstance().name(bound_symbol(value)) << ": ";
+        out << program.lambdas[value.lambda()].number << "]";
+    } else if (value.kind() == ValueKind::STRING) {
+        out << value.asString();
     } else {
-        throw std::runtime_error("Invalid lambda node type");
+        out << value_text(value);
     }
 }
 
-// NOLINTNEXTLINE
-CseNode Env::get_variable(const std::string &identifier) {
-    if (variables.find(identifier) != variables.end()) {
-        return variables[identifier];
-    } else if (parent_env != nullptr) {
-        return parent_env->get_variable(identifier);
-    } else {
-        throw std::runtime_error("Identifier: " + identifier + " not found");
-    }
-}
+void CSE::bind_arguments(const Value &closure) {
+    const Lambda &lambda = program.lambdas[closure.lambda()];
+    Value value = stack.pop();
 
-// NOLINTNEXTLINE
-CseNode Env::get_lambda(const std::string &identifier) {
-    if (lambdas.find(identifier) != lambdas.end()) {
-        return lambdas[identifier];
-    } else if (parent_env != nullptr) {
-        return parent_env->get_lambda(identifier);
-    } else {
-        throw std::runtime_error("Identifier: " + identifier + " not found");
-    }
-}
-
-// NOLINTNEXTLINE
-std::vector<CseNode> Env::get_list(const std::string &identifier) {
-    if (lists.find(identifier) != lists.end()) {
-        return lists[identifier];
-    } else if (parent_env != nullptr) {
-        return parent_env->get_list(identifier);
-    } else {
-        throw std::runtime_error("Identifier: " + identifier + " not found");
+    if (value.kind() == ValueKind::BOOLEAN || value.kind() == ValueKind::BUILTIN ||
+        value.kind() == ValueKind::ENV) {
+        throw std::runtime_error("Invalid object for gamma: " + value_text(value));
     }
-}
 
+    Value marker = Value::newEnv(closure.env(), closure.lambda(), env_count++, lambda.variableCount);
+    Env *new_env = marker.env();
 
-// NOLINTNEXTLINE
-void CSE::create_cs(TreeNode *root, ControlStructure *current_cs, int current_cs_index) {
-    ControlStructure *cs;
+    if (!lambda.tuple) {
+        new_env->bind(value);
+    } else if (value.kind() == ValueKind::TUPLE) {
+        const Tuple &elements = value.asTuple();
 
-    if (next_cs == -1) {
-        next_cs++;
-        cs = new ControlStructure(next_cs++);
-        control_structures.push_back(cs);
-        current_cs_index = 0;
-    } else {
-        cs = current_cs;
-    }
+        // elements beyond the bound variables are ignored, and variables beyond the elements stay unbound
+        uint32_t count = std::min(elements.size(), lambda.variableCount);
 
-    if (root->getLabel() == "lambda") {
-        CseNode *lambda;
-        if (root->getChildren()[0]->getLabel() == ",") {
-            std::vector<std::string> vars;
-            for (auto &child: root->getChildren()[0]->getChildren()) {
-                vars.push_back(child->getValue());
-            }
-            lambda = new CseNode(ObjType::LAMBDA, next_cs, vars);
-        } else {
-            std::string var = root->getChildren()[0]->getValue();
-            lambda = new CseNode(ObjType::LAMBDA, var, next_cs);
+        for (uint32_t i = 0; i < count; i++) {
+            new_env->bind(elements[i]);
         }
+    }
+    // any other argument leaves a tuple of variables unbound
 
-        cs->add_node(*lambda);
-
-        auto *new_cs = new ControlStructure(next_cs);
-        control_structures.push_back(new_cs);
-        create_cs(root->getChildren()[1], new_cs, next_cs++);
-    } else if (root->getLabel() == "tau") {
-        auto *tau = new CseNode(ObjType::TAU, std::to_string(root->getChildren().size()));
-        cs->add_node(*tau);
-
-        for (auto &child: root->getChildren()) {
-            create_cs(child, cs, current_cs_index);
-        }
-    } else if (root->getLabel() == "->") {
-        int then_index = next_cs++;
-        int else_index = next_cs++;
-        auto *delta_then = new CseNode(ObjType::DELTA, std::to_string(then_index));
-        auto *delta_else = new CseNode(ObjType::DELTA, std::to_string(else_index));
-        auto *beta = new CseNode(ObjType::BETA, "");
-
-        cs->add_node(*delta_then);
-        cs->add_node(*delta_else);
-        cs->add_node(*beta);
-
-        auto *then_cs = new ControlStructure(then_index);
-        control_structures.push_back(then_cs);
-        create_cs(root->getChildren()[1], then_cs, then_index);
-
-        auto *else_cs = new ControlStructure(else_index);
-        control_structures.push_back(else_cs);
-        create_cs(root->getChildren()[2], else_cs, else_index);
-
-        create_cs(root->getChildren()[0], cs, current_cs_index);
-    } else if (isOperator(root->getLabel())) {
-        auto *op = new CseNode(ObjType::OPERATOR, root->getLabel());
-        cs->add_node(*op);
-
-        for (auto &child: root->getChildren()) {
-            create_cs(child, cs, current_cs_index);
-        }
-    } else if (root->getLabel() == "gamma") {
-        auto *gamma = new CseNode(ObjType::GAMMA, "");
-        cs->add_node(*gamma);
+    env_stack.push_back(marker);
+    stack.push(std::move(marker));
+}
 
-        for (auto &child: root->getChildren()) {
-            create_cs(child, cs, current_cs_index);
-        }
-    } else if (root->getLabel() == "identifier" || root->getLabel() == "integer" || root->getLabel() == "string") {
-        std::string value = root->getValue();
-        std::string type = root->getLabel();
-        CseNode *leaf;
-
-        if (type == "identifier") {
-            leaf = new CseNode(ObjType::IDENTIFIER, value);
-        } else if (type == "integer") {
-            leaf = new CseNode(ObjType::INTEGER, value);
-        } else if (type == "string") {
-            leaf = new CseNode(ObjType::STRING, value);
-        } else {
-            throw std::runtime_error("Invalid leaf type: " + type);
+void CSE::evaluate() {
+    // the global environment binds every built-in function to the slot of its symbol ID, then nil
+    Value global_marker = Value::newEnv(nullptr, UINT32_MAX, env_count++, GLOBAL_SLOT_COUNT);
+    Env *global_env = global_marker.env();
+    for (symbol_id function = 0; function < BUILTIN_COUNT; function++) {
+        global_env->bind(Value::builtin(function));
+    }
+    global_env->bind(Value::tuple({}));
+
+    env_stack.push_back(global_marker);
+    stack.push(std::move(global_marker));
+
+    // Literals are turned into values once, up front. The constant pool is shared by integer and
+    // string literals, so each instruction says which of the two it wants
+    integer_constants.assign(program.constants.size(), Value());
+    string_constants.assign(program.constants.size(), Value());
+    for (const std::vector<uint8_t> &block_code : program.blocks) {
+        for (size_t at = 0; at < block_code.size(); at += instructionLength(static_cast<Opcode>(block_code[at]))) {
+            auto instruction = static_cast<Opcode>(block_code[at]);
+
+            if (instruction == Opcode::PUSH_INTEGER) {
+                uint32_t index = readOperand(&block_code[at + 1]);
+                integer_constants[index] = parse_integer(program.constants[index]);
+            } else if (instruction == Opcode::PUSH_STRING) {
+                uint32_t index = readOperand(&block_code[at + 1]);
+                string_constants[index] = Value::string(program.constants[index]);
+            }
         }
-
-        cs->add_node(*leaf);
-    } else {
-        throw std::runtime_error("Invalid node type: " + root->getLabel() + "Value: " + root->getValue());
     }
-}
 
-void CSE::evaluate() {
-    auto *e0 = new CseNode(ObjType::ENV, "0");
-    main_control_structure.add_node(*e0);
-    stack.add_node(*e0);
-    env_stack.push_back(next_env++);
-    envs[0] = new Env(nullptr);
-
-    main_control_structure.push_control_structure(*control_structures[0]);
-
-    CseNode top_of_cs = main_control_structure.pop_and_return_last_node();
-
-    while ((top_of_cs.get_node_type() != ObjType::ENV) || (top_of_cs.get_node_value() != "0")) {
-        if (top_of_cs.get_node_type() == ObjType::INTEGER || top_of_cs.get_node_type() == ObjType::STRING) {
-            stack.add_node(top_of_cs);
-            top_of_cs = main_control_structure.pop_and_return_last_node();
-        } else if (top_of_cs.get_node_type() == ObjType::IDENTIFIER) {
-            CseNode value;
-            CseNode value_l;
-            std::vector<CseNode> list;
-
-            try {
-                value = envs[env_stack.back()]->get_variable(top_of_cs.get_node_value());
-                stack.add_node(CseNode(value.get_node_type(), value.get_node_value()));
+    // Instead of copying control structures onto a control stack, run each block in place: the
+    // running block and the offset of its next instruction are kept here, and applying a lambda
+    // saves them in a frame that RETURN resumes
+    uint32_t block = 0;
+    const uint8_t *code = program.blocks[0].data();
+    uint32_t pc = 0;
+
+    while (true) {
+        uint32_t instruction_pc = pc;
+        Opcode op = static_cast<Opcode>(code[pc]);
+        uint32_t operand = operandCount(op) > 0 ? readOperand(code + pc + 1) : 0;
+        pc += instructionLength(op);
+
+        if (op == Opcode::HALT) {
+            break;
+        } else if (op == Opcode::PUSH_INTEGER) {
+            stack.push(integer_constants[operand]);
+        } else if (op == Opcode::PUSH_STRING) {
+            stack.push(string_constants[operand]);
+        } else if (op == Opcode::LOAD) {
+            // the compiler resolved the identifier to a slot of the environment operand levels out
+            uint32_t slot = readOperand(code + instruction_pc + 1 + sizeof(uint32_t));
+            const Value *value = env_stack.back().env()->lookup(operand, slot);
+
+            if (value == nullptr) {
+                const Lambda &lambda = program.lambdas[env_stack.back().env()->enclosing(operand)->lambda()];
+                throw std::runtime_error("Variable not found: " +
+                                         SymbolTable::getInstance().name(program.variables[lambda.firstVariable + slot]));
             }
-            catch (std::runtime_error &e) {
-                try {
-                    value_l = envs[env_stack.back()]->get_lambda(top_of_cs.get_node_value());
-                    stack.add_node(value_l);
-                }
-                catch (std::runtime_error &e) {
-                    try {
-                        list = envs[env_stack.back()]->get_list(top_of_cs.get_node_value());
-                        stack.add_node(CseNode(ObjType::LIST, list));
-                    }
-                    catch (std::runtime_error &e) {
-                        // if node value is in built_in_functions add the node to the stack
-                        if (std::find(built_in_functions.begin(), built_in_functions.end(),
-                                      top_of_cs.get_node_value()) !=
-                            built_in_functions.end()) {
-                            stack.add_node(top_of_cs);
-                        } else if (top_of_cs.get_node_value() == "nil") {
-                            stack.add_node(CseNode(ObjType::LIST, std::vector<CseNode>()));
-                        } else {
-                            throw std::runtime_error("Variable not found: " + top_of_cs.get_node_value());
-                        }
+            stack.push(*value);
+        } else if (op == Opcode::LOAD_GLOBAL) {
+            stack.push(*env_stack.front().env()->lookup(0, operand));
+        } else if (op == Opcode::UNBOUND) {
+            throw std::runtime_error("Variable not found: " + SymbolTable::getInstance().name(program.symbols[operand]));
+        } else if (op == Opcode::CLOSURE) {
+            stack.push(Value::closure(operand, env_stack.back().env()));
+        } else if (op == Opcode::APPLY) {
+            Value top_of_stack = stack.pop();
+
+            if (top_of_stack.kind() == ValueKind::CLOSURE) {
+                // When the running body returns whatever this application gives, it is a tail call:
+                // the body's ENV marker, right under the argument, and its environment are dropped
+                // and no frame is saved, so the callee returns straight to this body's caller and
+                // tail-recursive loops run in constant space. Anything else between the marker and
+                // the argument would be carried back by RETURN, so such calls are made as usual
+                bool tail_call = static_cast<Opcode>(code[skip_jumps(code, pc)]) == Opcode::RETURN;
+                if (tail_call) {
+                    Value argument = stack.pop();
+
+                    if (stack.length() > 0 && stack.peek().kind() == ValueKind::ENV &&
+                        stack.peek().env() == env_stack.back().env()) {
+                        stack.pop();
+                        env_stack.pop_back();
+                    } else {
+                        tail_call = false;
                     }
+                    stack.push(std::move(argument));
                 }
-            }
-
-            top_of_cs = main_control_structure.pop_and_return_last_node();
-        } else if (top_of_cs.get_node_type() == ObjType::LAMBDA) {
-            int current_env = env_stack.back();
-            stack.add_node(top_of_cs.set_env(current_env));
-
-            top_of_cs = main_control_structure.pop_and_return_last_node();
-        } else if (top_of_cs.get_node_type() == ObjType::GAMMA) {
-            CseNode top_of_stack = stack.pop_and_return_last_node();
-
-            if (top_of_stack.get_node_type() == ObjType::LAMBDA) {
-                Env *new_env = new Env(envs[top_of_stack.get_env()]);
-                envs[next_env++] = new_env;
-
-                CseNode value = stack.pop_and_return_last_node();
-
-                if (value.get_node_type() == ObjType::LAMBDA || value.get_node_type() == ObjType::EETA) {
-                    new_env->add_lambda(top_of_stack.get_node_value(), value);
-                } else if (value.get_node_type() == ObjType::STRING || value.get_node_type() == ObjType::INTEGER) {
-                    new_env->add_variable(top_of_stack.get_node_value(), value);
-                } else if (value.get_node_type() == ObjType::LIST && !top_of_stack.get_is_single_bound_var()) {
-                    // TODO
-                    std::vector<std::string> var_list = top_of_stack.get_var_list();
-                    std::vector<CseNode> list_items = value.get_list_elements();
-
-//                        std::vector<std::string> non_list_var;
-                    std::vector<std::string> list_var;
-                    std::vector<CseNode> temp_list = std::vector<CseNode>();
-
-                    int var_count = 0;
-
-                    int list_element_count = 0;
-                    bool creating_list = false;
-
-                    for (const auto &i: list_items) {
-                        if (creating_list) {
-                            temp_list.push_back(i);
-                            list_element_count--;
-
-                            if (list_element_count == 0) {
-                                new_env->add_list(var_list[var_count++], temp_list);
-                                temp_list = std::vector<CseNode>();
-                                creating_list = false;
-                            }
-                        } else {
-                            if (i.get_node_type() == ObjType::LIST) {
-                                list_element_count = std::stoi(i.get_node_value());
-                                if (list_element_count == 0) {
-                                    new_env->add_list(var_list[var_count++], temp_list);
-                                    temp_list = std::vector<CseNode>();
-                                } else {
-                                    creating_list = true;
-                                }
-                            } else if (i.get_node_type() == ObjType::LAMBDA) {
-                                new_env->add_lambda(var_list[var_count++], i);
-                            } else {
-                                new_env->add_variable(var_list[var_count++], i);
-                            }
-                        }
-                    }
-
-                    if (creating_list) {
-                        new_env->add_list(var_list[var_count], temp_list);
-                    }
-                } else if (value.get_node_type() == ObjType::LIST) {
-                    new_env->add_list(top_of_stack.get_node_value(), value.get_list_elements());
-                } else {
-                    throw std::runtime_error("Invalid object for gamma: " + value.get_node_value());
+                if (!tail_call) {
+                    frames.push_back({block, pc});
                 }
 
-                env_stack.push_back(next_env - 1);
-                auto *env_obj = new CseNode(ObjType::ENV, std::to_string(next_env - 1));
-                main_control_structure.add_node(*env_obj);
-                stack.add_node(*env_obj);
-                main_control_structure.push_control_structure(*control_structures[top_of_stack.get_cs_index()]);
-            } else if (top_of_stack.get_node_type() == ObjType::IDENTIFIER) {
+                bind_arguments(top_of_stack);
+
+                block = program.lambdas[top_of_stack.lambda()].body;
+                code = program.blocks[block].data();
+                pc = 0;
+            } else if (top_of_stack.kind() == ValueKind::BUILTIN) {
                 // TODO: built-in functions should be handled here
-                std::string identifier = top_of_stack.get_node_value();
-
-                if (identifier == "Print") {
-                    CseNode value = stack.pop_and_return_last_node();
-                    std::vector<CseNode> list_elements = value.get_list_elements();
-
-                    if (value.get_node_type() == ObjType::LIST) {
-                        std::cout << "(";
-
-                        std::vector<int> count_stack;
-
-                        for (int i = 0; i < value.get_list_elements().size(); i++) {
-                            if (list_elements[i].get_node_type() == ObjType::LIST) {
-                                count_stack.push_back(std::stoi(list_elements[i].get_node_value()));
-                                std::cout << "(";
-                            } else {
-                                std::cout << list_elements[i].get_node_value();
-
-                                if (!count_stack.empty()) {
-                                    // reduce 1 from all elements in count_stack
-                                    for (int &count: count_stack) {
-                                        count--;
-                                    }
-
-                                    if (count_stack[count_stack.size() - 1] == 0) {
-                                        if (i != value.get_list_elements().size() - 1)
-                                            std::cout << "), ";
-                                        else
-                                            std::cout << ")";
-
-                                        count_stack.pop_back();
-                                    } else {
-                                        if (i != value.get_list_elements().size() - 1)
-                                            std::cout << ", ";
-                                    }
-                                } else {
-                                    if (i != value.get_list_elements().size() - 1)
-                                        std::cout << ", ";
-                                }
-                            }
-                        }
-                        std::cout << ")";
-                    } else if (value.get_node_type() == ObjType::ENV || value.get_node_value() == "dummy") {
-                        std::cout << "dummy";
-                    } else if (value.get_node_type() == ObjType::LAMBDA) {
-                        std::cout << "[lambda closure: ";
-                        std::cout << value.get_node_value() << ": ";
-                        std::cout << value.get_cs_index() << "]";
+                symbol_id identifier = top_of_stack.asBuiltin();
+
+                if (identifier == SYM_PRINT) {
+                    print_value(stack.pop());
+                } else if (identifier == SYM_ISINTEGER) {
+                    Value value = stack.pop();
+                    stack.push(Value::boolean(value.isInteger()));
+                } else if (identifier == SYM_ISSTRING) {
+                    Value value = stack.pop();
+                    stack.push(Value::boolean(value.kind() == ValueKind::STRING));
+                } else if (identifier == SYM_ISEMPTY) {
+                    Value value = stack.pop();
+                    if (value.kind() == ValueKind::TUPLE) {
+                        stack.push(Value::boolean(value.asTuple().size() == 0));
                     } else {
-                        std::cout << value.get_node_value();
+                        throw std::runtime_error("Invalid type for IsEmpty: " + value_text(value));
                     }
-                } else if (identifier == "Isinteger") {
-                    CseNode value = stack.pop_and_return_last_node();
-                    if (value.get_node_type() == ObjType::INTEGER) {
-                        stack.add_node(CseNode(ObjType::BOOLEAN, "true"));
+                } else if (identifier == SYM_ISTUPLE) {
+                    Value value = stack.pop();
+                    stack.push(Value::boolean(value.kind() == ValueKind::TUPLE));
+                } else if (identifier == SYM_ORDER) {
+                    Value value = stack.pop();
+                    if (value.kind() == ValueKind::TUPLE) {
+                        stack.push(Value::integer(static_cast<int64_t>(value.asTuple().size())));
                     } else {
-                        stack.add_node(CseNode(ObjType::BOOLEAN, "false"));
+                        throw std::runtime_error("Invalid type for Order: " + value_text(value));
                     }
-                } else if (identifier == "Isstring") {
-                    CseNode value = stack.pop_and_return_last_node();
-                    if (value.get_node_type() == ObjType::STRING) {
-                        stack.add_node(CseNode(ObjType::BOOLEAN, "true"));
-                    } else {
-                        stack.add_node(CseNode(ObjType::BOOLEAN, "false"));
+                } else if (identifier == SYM_CONC) {
+                    Value first_arg = stack.pop();
+                    Value second_arg = stack.pop();
+
+                    // Conc takes both arguments at once, so the gamma that would apply it to the
+                    // second one is skipped
+                    uint32_t next = skip_jumps(code, pc);
+                    if (static_cast<Opcode>(code[next]) == Opcode::APPLY) {
+                        pc = next + instructionLength(Opcode::APPLY);
                     }
-                } else if (identifier == "Isempty") {
-                    CseNode value = stack.pop_and_return_last_node();
-                    if (value.get_node_type() == ObjType::LIST) {
-                        if (value.get_list_elements().empty()) {
-                            stack.add_node(CseNode(ObjType::BOOLEAN, "true"));
-                        } else {
-                            stack.add_node(CseNode(ObjType::BOOLEAN, "false"));
-                        }
-                    } else {
-                        throw std::runtime_error("Invalid type for IsEmpty: " + value.get_node_value());
-                    }
-                } else if (identifier == "Istuple") {
-                    CseNode value = stack.pop_and_return_last_node();
 
-                    if (value.get_node_type() == ObjType::LIST) {
-                        stack.add_node(CseNode(ObjType::BOOLEAN, "true"));
+                    if (first_arg.kind() == ValueKind::STRING &&
+                        (second_arg.kind() == ValueKind::STRING || second_arg.isInteger())) {
+                        Value suffix = second_arg.kind() == ValueKind::STRING ? std::move(second_arg)
+                                                                              : Value::string(value_text(second_arg));
+                        stack.push(Value::concatenation(std::move(first_arg), std::move(suffix)));
                     } else {
-                        stack.add_node(CseNode(ObjType::BOOLEAN, "false"));
+                        throw std::runtime_error("Invalid type for Conc: " + value_text(first_arg));
                     }
-                } else if (identifier == "Order") {
-                    CseNode value = stack.pop_and_return_last_node();
-                    if (value.get_node_type() == ObjType::LIST) {
-                        int count = 0;
-                        int list_elem_skip = 0;
-
-                        for (const auto &i: value.get_list_elements()) {
-                            if (i.get_node_type() == ObjType::LIST && list_elem_skip == 0) {
-                                list_elem_skip += std::stoi(i.get_node_value());
-                                count++;
-                            } else if (list_elem_skip == 0) {
-                                count++;
-                            } else {
-                                list_elem_skip--;
-                                continue;
-                            }
-                        }
-
-                        stack.add_node(CseNode(ObjType::INTEGER, std::to_string(count)));
-                    } else {
-                        throw std::runtime_error("Invalid type for Order: " + value.get_node_value());
-                    }
-                } else if (identifier == "Conc") {
-                    CseNode first_arg = stack.pop_and_return_last_node();
-                    CseNode second_arg = stack.pop_and_return_last_node();
-                    main_control_structure.pop_last_node();
-
-                    if (first_arg.get_node_type() == ObjType::STRING &&
-                        (second_arg.get_node_type() == ObjType::STRING ||
-                         second_arg.get_node_type() == ObjType::INTEGER)) {
-                        stack.add_node(
-                                CseNode(ObjType::STRING, first_arg.get_node_value() + second_arg.get_node_value()));
-                    } else {
-                        throw std::runtime_error("Invalid type for Conc: " + first_arg.get_node_value());
-                    }
-                } else if (identifier == "Stem") {
-                    CseNode arg = stack.pop_and_return_last_node();
+                } else if (identifier == SYM_STEM) {
+                    Value arg = stack.pop();
 
-                    if (arg.get_node_type() == ObjType::STRING) {
-                        stack.add_node(CseNode(ObjType::STRING, arg.get_node_value().substr(0, 1)));
+                    if (arg.kind() == ValueKind::STRING) {
+                        stack.push(Value::string(std::string(arg.asString().substr(0, 1))));
                     } else {
-                        throw std::runtime_error("Invalid type for Stem: " + top_of_stack.get_node_value());
+                        throw std::runtime_error("Invalid type for Stem: " + value_text(arg));
                     }
-                } else if (identifier == "Stern") {
-                    CseNode arg = stack.pop_and_return_last_node();
+                } else if (identifier == SYM_STERN) {
+                    Value arg = stack.pop();
 
-                    if (arg.get_node_type() == ObjType::STRING) {
-                        stack.add_node(CseNode(ObjType::STRING, arg.get_node_value().substr(1)));
+                    if (arg.kind() == ValueKind::STRING && !arg.asString().empty()) {
+                        stack.push(Value::suffix(arg, 1));
+                    } else if (arg.kind() == ValueKind::STRING) {
+                        throw std::runtime_error("Invalid argument for Stern: empty string");
                     } else {
-                        throw std::runtime_error("Invalid type for Stern: " + top_of_stack.get_node_value());
+                        throw std::runtime_error("Invalid type for Stern: " + value_text(arg));
                     }
-                } else if (identifier == "Y*") {
-                    CseNode lambda = stack.pop_and_return_last_node();
-
-                    if (lambda.get_node_type() == ObjType::LAMBDA) {
-                        if (lambda.get_is_single_bound_var()) {
-                            stack.add_node(CseNode(ObjType::EETA, lambda.get_node_value(), lambda.get_cs_index(),
-                                                   lambda.get_env()));
-                        } else {
-                            stack.add_node(CseNode(ObjType::EETA, lambda.get_cs_index(), lambda.get_var_list(),
-                                                   lambda.get_env()));
-                        }
+                } else if (identifier == SYM_Y_STAR) {
+                    Value lambda = stack.pop();
+
+                    if (lambda.kind() == ValueKind::CLOSURE) {
+                        stack.push(Value::eeta(lambda.lambda(), lambda.env()));
                     } else {
-                        throw std::runtime_error("Invalid type for Y*: " + lambda.get_node_value());
+                        throw std::runtime_error("Invalid type for Y*: " + value_text(lambda));
                     }
-                } else if (identifier == "ItoS") {
-                    CseNode arg = stack.pop_and_return_last_node();
+                } else if (identifier == SYM_ITOS) {
+                    Value arg = stack.pop();
 
-                    if (arg.get_node_type() == ObjType::INTEGER) {
-                        stack.add_node(CseNode(ObjType::STRING, arg.get_node_value()));
+                    if (arg.isInteger()) {
+                        stack.push(Value::string(value_text(arg)));
                     } else {
-                        throw std::runtime_error("Invalid type for ItoS: " + arg.get_node_value());
+                        throw std::runtime_error("Invalid type for ItoS: " + value_text(arg));
                     }
                 }
-            } else if (top_of_stack.get_node_type() == ObjType::EETA) {
-                stack.add_node(top_of_stack);
-
-                if (top_of_stack.get_is_single_bound_var()) {
-                    stack.add_node(
-                            CseNode(ObjType::LAMBDA, top_of_stack.get_node_value(), top_of_stack.get_cs_index(),
-                                    top_of_stack.get_env()));
+            } else if (top_of_stack.kind() == ValueKind::EETA) {
+                // Apply the lambda to the eeta, then run this gamma again to apply the result to
+                // the argument
+                stack.push(top_of_stack);
+                bind_arguments(Value::closure(top_of_stack.lambda(), top_of_stack.env()));
+
+                frames.push_back({block, instruction_pc});
+                block = program.lambdas[top_of_stack.lambda()].body;
+                code = program.blocks[block].data();
+                pc = 0;
+            } else if (top_of_stack.kind() == ValueKind::TUPLE) {
+                Value second_arg = stack.pop();
+
+                if (second_arg.kind() == ValueKind::INTEGER) {
+                    int64_t index = second_arg.asInteger();
+                    const Tuple &elements = top_of_stack.asTuple();
+
+                    if (index < 1 || index > static_cast<int64_t>(elements.size())) {
+                        throw std::runtime_error("Invalid index for tuple: " + std::to_string(index));
+                    }
+                    stack.push(elements[static_cast<uint32_t>(index - 1)]);
+                } else if (second_arg.kind() == ValueKind::BIG_INTEGER) {
+                    throw std::runtime_error("Invalid index for tuple: " + value_text(second_arg));
                 } else {
-                    stack.add_node(
-                            CseNode(ObjType::LAMBDA, top_of_stack.get_cs_index(), top_of_stack.get_var_list(),
-                                    top_of_stack.get_env()));
+                    throw std::runtime_error("Invalid type for Index: " + value_text(second_arg));
                 }
+            }
+        } else if (op == Opcode::RETURN) {
+            std::vector<Value> env_values = {};
 
-                main_control_structure.add_node(CseNode(ObjType::GAMMA, ""));
-                main_control_structure.add_node(CseNode(ObjType::GAMMA, ""));
-            } else if (top_of_stack.get_node_type() == ObjType::LIST) {
-                CseNode second_arg = stack.pop_and_return_last_node();
-
-                if (second_arg.get_node_type() == ObjType::INTEGER) {
-                    int index = std::stoi(second_arg.get_node_value());
-
-                    int current_index = 0;
-                    int list_element_pos = 0;
-                    int list_elem_skip = 0;
-                    bool is_list = false;
-
-                    for (const auto &i: top_of_stack.get_list_elements()) {
-                        if (i.get_node_type() == ObjType::LIST && list_elem_skip == 0) {
-                            list_elem_skip = std::stoi(i.get_node_value());
-                            current_index++;
-
-                            if (index == current_index) {
-                                is_list = true;
-                                break;
-                            }
-                        } else if (list_elem_skip == 0) {
-                            current_index++;
-
-                            if (index == current_index) {
-                                break;
-                            }
-                        } else {
-                            list_elem_skip--;
-                        }
-                        list_element_pos++;
-                    }
-
-                    std::vector<CseNode> list_elements = std::vector<CseNode>();
-
-                    if (is_list) {
-                        int length = std::stoi(top_of_stack.get_list_elements()[list_element_pos].get_node_value());
+            Value st_value = stack.pop();
 
-                        for (int i = 0; i < length; i++) {
-                            list_elements.push_back(top_of_stack.get_list_elements()[list_element_pos + i + 1]);
-                        }
+            while (st_value.kind() != ValueKind::ENV) {
+                env_values.push_back(std::move(st_value));
+                st_value = stack.pop();
+            }
 
-                        stack.add_node(CseNode(ObjType::LIST, list_elements));
-                    } else {
-                        stack.add_node(top_of_stack.get_list_elements()[list_element_pos]);
-                    }
-                } else {
-                    throw std::runtime_error("Invalid type for Index: " + second_arg.get_node_value());
-                }
+            // push back the stack from vector
+            for (auto it = env_values.rbegin(); it != env_values.rend(); ++it) {
+                stack.push(std::move(*it));
             }
 
-            top_of_cs = main_control_structure.pop_and_return_last_node();
-        } else if (top_of_cs.get_node_type() == ObjType::ENV) {
-            std::vector<CseNode> env_nodes = {};
+            env_stack.pop_back();
 
-            CseNode st_node = stack.pop_and_return_last_node();
+            block = frames.back().block;
+            pc = frames.back().pc;
+            code = program.blocks[block].data();
+            frames.pop_back();
+        } else if (op == Opcode::TUPLE) {
+            std::vector<Value> tau_elements;
+            tau_elements.reserve(std::min<size_t>(operand, stack.length()));
 
-            while (st_node.get_node_type() != ObjType::ENV) {
-                env_nodes.push_back(st_node);
-                st_node = stack.pop_and_return_last_node();
+            for (uint32_t i = 0; i < operand; i++) {
+                tau_elements.push_back(stack.pop());
             }
 
-            // push back the stack from vector
-            for (auto it = env_nodes.rbegin(); it != env_nodes.rend(); ++it) {
-                stack.add_node(*it);
+            stack.push(Value::tuple(std::move(tau_elements)));
+        } else if (op == Opcode::JUMP) {
+            pc = operand;
+        } else if (op == Opcode::JUMP_IF_FALSE) {
+            Value value = stack.pop();
+            bool condition;
+
+            if (value.kind() == ValueKind::BOOLEAN) {
+                condition = value.asBoolean();
+            } else if (value.kind() == ValueKind::INTEGER) {
+                condition = value.asInteger() != 0;
+            } else if (value.kind() == ValueKind::BIG_INTEGER) {
+                condition = true;
+            } else {
+                throw std::runtime_error("Invalid type for beta: " + value_text(value));
             }
 
-            env_stack.pop_back();
+            if (!condition) {
+                pc = operand;
+            }
+        } else {
+            // every other instruction applies an operator
+            Opcode operator_ = op;
 
-            top_of_cs = main_control_structure.pop_and_return_last_node();
-        } else if (top_of_cs.get_node_type() == ObjType::OPERATOR) {
-            std::string operator_ = top_of_cs.get_node_value();
-
-            CseNode first = stack.pop_and_return_last_node();
-            CseNode second = stack.pop_and_return_last_node();
-
-            if (operator_ == "+") {
-                stack.add_node(CseNode(ObjType::INTEGER, std::to_string(
-                        std::stoi(first.get_node_value()) + std::stoi(second.get_node_value()))));
-            } else if (operator_ == "-") {
-                stack.add_node(CseNode(ObjType::INTEGER, std::to_string(
-                        std::stoi(first.get_node_value()) - std::stoi(second.get_node_value()))));
-            } else if (operator_ == "/") {
-                stack.add_node(CseNode(ObjType::INTEGER, std::to_string(
-                        std::stoi(first.get_node_value()) / std::stoi(second.get_node_value()))));
-            } else if (operator_ == "*") {
-                stack.add_node(CseNode(ObjType::INTEGER, std::to_string(
-                        std::stoi(first.get_node_value()) * std::stoi(second.get_node_value()))));
-            } else if (operator_ == "neg") {
-                stack.add_node(second);
-                stack.add_node(CseNode(ObjType::INTEGER, std::to_string(-std::stoi(first.get_node_value()))));
-            } else if (operator_ == "not") {
-                stack.add_node(second);
-                if (first.get_node_value() == "true") {
-                    stack.add_node(CseNode(ObjType::BOOLEAN, "false"));
-                } else {
-                    stack.add_node(CseNode(ObjType::BOOLEAN, "true"));
-                }
-            } else if (operator_ == "eq") {
-                if (first.get_node_value() == second.get_node_value()) {
-                    stack.add_node(CseNode(ObjType::BOOLEAN, "true"));
-                } else {
-                    stack.add_node(CseNode(ObjType::BOOLEAN, "false"));
-                }
-            } else if (operator_ == "gr") {
-                if (std::stoi(first.get_node_value()) > std::stoi(second.get_node_value())) {
-                    stack.add_node(CseNode(ObjType::BOOLEAN, "true"));
-                } else {
-                    stack.add_node(CseNode(ObjType::BOOLEAN, "false"));
-                }
-            } else if (operator_ == "ge") {
-                if (std::stoi(first.get_node_value()) >= std::stoi(second.get_node_value())) {
-                    stack.add_node(CseNode(ObjType::BOOLEAN, "true"));
-                } else {
-                    stack.add_node(CseNode(ObjType::BOOLEAN, "false"));
-                }
-            } else if (operator_ == "ls") {
-                if (std::stoi(first.get_node_value()) < std::stoi(second.get_node_value())) {
-                    stack.add_node(CseNode(ObjType::BOOLEAN, "true"));
+            Value first = stack.pop();
+            Value second = stack.pop();
+
+            // Two inline integers are worked on directly. Anything else, and any result that
+            // overflows 64 bits, goes through BigInt
+            bool inline_operands = first.kind() == ValueKind::INTEGER && second.kind() == ValueKind::INTEGER;
+            int64_t result;
+
+            if (operator_ == Opcode::ADD) {
+                if (inline_operands && !__builtin_add_overflow(first.asInteger(), second.asInteger(), &result)) {
+                    stack.push(Value::integer(result));
                 } else {
-                    stack.add_node(CseNode(ObjType::BOOLEAN, "false"));
+                    BigInt augend = integer_of(first);
+                    stack.push(Value::integer(augend + integer_of(second)));
                 }
-            } else if (operator_ == "le") {
-                if (std::stoi(first.get_node_value()) <= std::stoi(second.get_node_value())) {
-                    stack.add_node(CseNode(ObjType::BOOLEAN, "true"));
+            } else if (operator_ == Opcode::SUBTRACT) {
+                if (inline_operands && !__builtin_sub_overflow(first.asInteger(), second.asInteger(), &result)) {
+                    stack.push(Value::integer(result));
                 } else {
-                    stack.add_node(CseNode(ObjType::BOOLEAN, "false"));
+                    BigInt minuend = integer_of(first);
+                    stack.push(Value::integer(minuend - integer_of(second)));
                 }
-            } else if (operator_ == "ne") {
-                if (first.get_node_value() != second.get_node_value()) {
-                    stack.add_node(CseNode(ObjType::BOOLEAN, "true"));
+            } else if (operator_ == Opcode::DIVIDE) {
+                if (inline_operands && second.asInteger() != 0 &&
+                    !(first.asInteger() == INT64_MIN && second.asInteger() == -1)) {
+                    stack.push(Value::integer(first.asInteger() / second.asInteger()));
                 } else {
-                    stack.add_node(CseNode(ObjType::BOOLEAN, "false"));
+                    BigInt dividend = integer_of(first);
+                    stack.push(Value::integer(dividend / integer_of(second)));
                 }
-            } else if (operator_ == "aug") {
-                if (first.get_node_type() == ObjType::LIST) {
-                    if (second.get_node_type() == ObjType::LIST) {
-                        std::vector<CseNode> elements = first.get_list_elements();
-                        std::vector<CseNode> elements_2 = second.get_list_elements();
-
-                        elements.emplace_back(ObjType::LIST, std::to_string(elements_2.size()));
-
-                        for (auto &element: elements_2) {
-                            elements.push_back(element);
-                        }
-
-                        stack.add_node(CseNode(ObjType::LIST, elements));
-                    } else if (second.get_node_type() == ObjType::INTEGER ||
-                               second.get_node_type() == ObjType::BOOLEAN ||
-                               second.get_node_type() == ObjType::STRING) {
-                        std::vector<CseNode> elements = first.get_list_elements();
-
-                        elements.emplace_back(second.get_node_type(), second.get_node_value());
-                        stack.add_node(CseNode(ObjType::LIST, elements));
-                    } else {
-                        throw std::runtime_error("Invalid type for aug: " + second.get_node_value());
-                    }
+            } else if (operator_ == Opcode::MULTIPLY) {
+                if (inline_operands && !__builtin_mul_overflow(first.asInteger(), second.asInteger(), &result)) {
+                    stack.push(Value::integer(result));
                 } else {
-                    throw std::runtime_error("Invalid type for aug: " + first.get_node_value());
+                    BigInt multiplicand = integer_of(first);
+                    stack.push(Value::integer(multiplicand * integer_of(second)));
                 }
-            } else if (operator_ == "or") {
-                if (first.get_node_value() == "true" || second.get_node_value() == "true") {
-                    stack.add_node(CseNode(ObjType::BOOLEAN, "true"));
+            } else if (operator_ == Opcode::NEG) {
+                Value negated = first.kind() == ValueKind::INTEGER && first.asInteger() != INT64_MIN
+                                ? Value::integer(-first.asInteger())
+                                : Value::integer(-integer_of(first));
+                stack.push(std::move(second));
+                stack.push(std::move(negated));
+            } else if (operator_ == Opcode::NOT) {
+                bool value = is_true(first);
+                stack.push(std::move(second));
+                stack.push(Value::boolean(!value));
+            } else if (operator_ == Opcode::EQ || operator_ == Opcode::NE) {
+                bool equal;
+
+                if (inline_operands) {
+                    equal = first.asInteger() == second.asInteger();
+                } else if (first.isInteger() && second.isInteger()) {
+                    equal = BigInt::compare(first.asBigInt(), second.asBigInt()) == 0;
+                } else if (first.kind() == ValueKind::STRING && second.kind() == ValueKind::STRING) {
+                    equal = first.asString() == second.asString();
+                } else if (first.kind() == ValueKind::BOOLEAN && second.kind() == ValueKind::BOOLEAN) {
+                    equal = first.asBoolean() == second.asBoolean();
                 } else {
-                    stack.add_node(CseNode(ObjType::BOOLEAN, "false"));
+                    // values of different kinds are equal if they read the same
+                    equal = value_text(first) == value_text(second);
                 }
-            } else if (operator_ == "&") {
-                if (first.get_node_value() == "true" && second.get_node_value() == "true") {
-                    stack.add_node(CseNode(ObjType::BOOLEAN, "true"));
-                } else {
-                    stack.add_node(CseNode(ObjType::BOOLEAN, "false"));
-                }
-            } else {
-                throw std::runtime_error("Invalid operator: " + operator_);
-            }
 
-            top_of_cs = main_control_structure.pop_and_return_last_node();
-        } else if (top_of_cs.get_node_type() == ObjType::TAU) {
-            std::vector<CseNode> tau_elements;
-            int tau_size = std::stoi(top_of_cs.get_node_value());
+                stack.push(Value::boolean(operator_ == Opcode::EQ ? equal : !equal));
+            } else if (operator_ == Opcode::GR || operator_ == Opcode::GE ||
+                       operator_ == Opcode::LS || operator_ == Opcode::LE) {
+                int order;
 
-            for (int i = 0; i < tau_size; i++) {
-                CseNode node = stack.pop_and_return_last_node();
-
-                if (node.get_node_type() == ObjType::LIST) {
-                    std::vector<CseNode> elements = node.get_list_elements();
-                    tau_elements.emplace_back(ObjType::LIST, std::to_string(elements.size()));
-
-                    for (auto &element: elements) {
-                        tau_elements.push_back(element);
-                    }
+                if (inline_operands) {
+                    order = (first.asInteger() > second.asInteger()) - (first.asInteger() < second.asInteger());
                 } else {
-                    tau_elements.push_back(node);
+                    BigInt left = integer_of(first);
+                    order = BigInt::compare(left, integer_of(second));
                 }
-            }
-
-            stack.add_node(CseNode(ObjType::LIST, tau_elements));
 
-            top_of_cs = main_control_structure.pop_and_return_last_node();
-        } else if (top_of_cs.get_node_type() == ObjType::BETA) {
-            CseNode node = stack.pop_and_return_last_node();
-
-            if (node.get_node_type() == ObjType::BOOLEAN) {
-                if (node.get_node_value() == "true") {
-                    main_control_structure.pop_last_node();
-                    CseNode true_node = main_control_structure.pop_and_return_last_node();
-
-                    if (true_node.get_node_type() == ObjType::DELTA) {
-                        main_control_structure.push_control_structure(
-                                *control_structures[std::stoi(true_node.get_node_value())]);
-                    } else {
-                        throw std::runtime_error("Invalid type for beta: " + true_node.get_node_value());
-                    }
+                if (operator_ == Opcode::GR) {
+                    stack.push(Value::boolean(order > 0));
+                } else if (operator_ == Opcode::GE) {
+                    stack.push(Value::boolean(order >= 0));
+                } else if (operator_ == Opcode::LS) {
+                    stack.push(Value::boolean(order < 0));
                 } else {
-                    CseNode false_node = main_control_structure.pop_and_return_last_node();
-                    main_control_structure.pop_last_node();
-
-                    if (false_node.get_node_type() == ObjType::DELTA) {
-                        main_control_structure.push_control_structure(
-                                *control_structures[std::stoi(false_node.get_node_value())]);
-                    } else {
-                        throw std::runtime_error("Invalid type for beta: " + false_node.get_node_value());
-                    }
+                    stack.push(Value::boolean(order <= 0));
                 }
-            } else if (node.get_node_type() == ObjType::INTEGER) {
-                if (node.get_node_value() != "0") {
-                    main_control_structure.pop_last_node();
-                    CseNode true_node = main_control_structure.pop_and_return_last_node();
-
-                    if (true_node.get_node_type() == ObjType::DELTA) {
-                        main_control_structure.push_control_structure(
-                                *control_structures[std::stoi(true_node.get_node_value())]);
+            } else if (operator_ == Opcode::AUG) {
+                if (first.kind() == ValueKind::TUPLE) {
+                    if (second.kind() == ValueKind::TUPLE ||
+                        second.isInteger() ||
+                        second.kind() == ValueKind::BOOLEAN ||
+                        second.kind() == ValueKind::STRING) {
+                        stack.push(Value::append(std::move(first), std::move(second)));
                     } else {
-                        throw std::runtime_error("Invalid type for beta: " + true_node.get_node_value());
+                        throw std::runtime_error("Invalid type for aug: " + value_text(second));
                     }
                 } else {
-                    CseNode false_node = main_control_structure.pop_and_return_last_node();
-                    main_control_structure.pop_last_node();
-
-                    if (false_node.get_node_type() == ObjType::DELTA) {
-                        main_control_structure.push_control_structure(
-                                *control_structures[std::stoi(false_node.get_node_value())]);
-                    } else {
-                        throw std::runtime_error("Invalid type for beta: " + false_node.get_node_value());
-                    }
+                    throw std::runtime_error("Invalid type for aug: " + value_text(first));
                 }
+            } else if (operator_ == Opcode::OR) {
+                stack.push(Value::boolean(is_true(first) || is_true(second)));
+            } else if (operator_ == Opcode::AND) {
+                stack.push(Value::boolean(is_true(first) && is_true(second)));
             } else {
-                throw std::runtime_error("Invalid type for beta: " + node.get_node_value());
+                throw std::runtime_error("Invalid operator: " + std::string(opcodeName(operator_)));
             }
-
-            top_of_cs = main_control_structure.pop_and_return_last_node();
         }
     }
 }
-
-bool isOperator(const std::string &label) {
-    std::vector<std::string> operators_ = {"+", "-", "/", "*", "aug", "neg", "not", "eq", "gr", "ge", "ls", "le", "ne",
-                                           "or", "&"};
-
-    auto it = std::find(operators_.begin(), operators_.end(), label);
-    return it != operators_.end();
-}
@@ -14,204 +14,120 @@
 #include <iostream>
 
 #include "Tree.h"
-
-// enum of node types for CSE machine
-enum class ObjType : int {
-    LAMBDA,
-    IDENTIFIER,
-    INTEGER,
-    STRING,
-    GAMMA,
-    OPERATOR,
-    BETA,
-    EETA,
-    DELTA,
-    TAU,
-    ENV,
-    LIST,
-    BOOLEAN
-};
-
-/**
- * Check if the given label is an operator.
- *
- * @param label The label to check.
- * @return True if the label is an operator, false otherwise.
- */
-bool isOperator(const std::string &label);
-
-
-#pragma clang diagnostic push
-#pragma ide diagnostic ignored "OCDFAInspection"
-
-// NOLINTNEXTLINE
-class CseNode {
-private:
-    // General node properties
-    ObjType node_type;
-    std::string node_value;
-
-    // CseNode properties for lambda and eeta nodes
-    int env{};
-    int cs_index{}; // for delta, tau, eeta, lambda nodes
-    std::vector<std::string> bound_variables;
-    std::vector<CseNode> list_elements;
-    bool is_single_bound_var = true;
-
-public:
-    CseNode() = default; // NOLINT(cppcoreguidelines-pro-type-member-init)
-
-    // Constructor for lambda (in stack) and eeta nodes
-    CseNode(ObjType node_type, std::string node_value, int cs_index, int env);
-
-    // Constructor for lambda (in control structure) nodes
-    CseNode(ObjType node_type, std::string node_value, int cs_index);
-
-    // Constructor for other nodes
-    CseNode(ObjType node_type, std::string node_value);
-
-    // Constructor for lambda (in cs) nodes with bound variables
-    CseNode(ObjType node_type, int cs_index, std::vector<std::string> bound_variables);
-
-    // Constructor for lambda (in stack) nodes with bound variables
-    CseNode(ObjType node_type, int cs_index, std::vector<std::string> bound_variables, int env);
-
-    CseNode(ObjType node_type, std::vector<CseNode> list_elements);
-
-    // Getters
-    [[nodiscard]] ObjType get_node_type() const;
-
-    [[nodiscard]] std::string get_node_value() const;
-
-    [[nodiscard]] int get_env() const;
-
-    [[nodiscard]] int get_cs_index() const;
-
-    [[nodiscard]] bool get_is_single_bound_var() const;
-
-    [[nodiscard]] std::vector<std::string> get_var_list() const;
-
-    std::vector<CseNode> get_list_elements();
-
-    CseNode set_env(int env_);
-};
-
-#pragma clang diagnostic pop
-
-
-class ControlStructure {
-private:
-    int cs_index;
-    std::vector<CseNode> nodes;
-
-public:
-    // Constructor with empty nodes
-    explicit ControlStructure(int cs_index);
-
-    // add node to control structure
-    void add_node(const CseNode &node);
-
-    // Getters
-    [[maybe_unused]] [[nodiscard]] int get_cs_index() const;
-
-    // return the last node in the control structure
-    [[maybe_unused]] [[nodiscard]] CseNode get_last_node() const;
-
-    // pop the last node in the control structure
-    void pop_last_node();
-
-    // pop and return the last node in the control structure
-    CseNode pop_and_return_last_node();
-
-    // push another control structure to the current control structure
-    void push_control_structure(const ControlStructure &cs);
+#include "SymbolTable.h"
+#include "Bytecode.h"
+#include "Value.h"
+#include "Tuple.h"
+#include "Text.h"
+
+// Where a caller resumes once the lambda body it applied returns
+struct Frame {
+    uint32_t block;
+    uint32_t pc;
 };
 
 class Stack {
 private:
-    std::vector<CseNode> nodes;
+    std::vector<Value> values;
 
 public:
-    // constructor with empty nodes
+    // constructor with empty values
     Stack() = default;
 
-    // add node to stack
-    void add_node(const CseNode &node);
+    // push a value onto the stack
+    void push(Value value);
 
-    // pop the last node in the stack
-    [[maybe_unused]] void pop_last_node();
+    // pop and return the last value in the stack
+    Value pop();
 
-    // pop and return the last node in the stack
-    CseNode pop_and_return_last_node();
+    // the last value in the stack, left in place
+    [[nodiscard]] const Value &peek() const;
 
     // length of the stack
-    [[maybe_unused]] [[nodiscard]] int length() const;
+    [[nodiscard]] int length() const;
 };
 
-class Env {
+class CSE {
 private:
-    std::unordered_map<std::string, CseNode> variables;
-    std::unordered_map<std::string, CseNode> lambdas;
-    std::unordered_map<std::string, std::vector<CseNode>> lists;
-    [[maybe_unused]] bool is_lambda = false;
-    Env *parent_env;
+    Program program;
+    std::vector<Frame> frames;
+    Stack stack = Stack();
+    std::vector<Value> env_stack = std::vector<Value>(); // ENV markers of the applications still running
+    uint32_t env_count = 0; // environments made so far, which numbers the next one
+    std::vector<Value> integer_constants; // The integer literals of the program, by constant index
+    std::vector<Value> string_constants;  // The string literals of the program, by constant index
+    std::ostream &out; // Where Print writes
 
 public:
-    // constructor with empty variables and lambdas
-    Env();
-
-    // constructor with empty variables and lambdas
-    explicit Env(Env *parent_env);
-
-    // add variable to environment
-    void add_variable(const std::string &identifier, const CseNode &value);
-
-    [[maybe_unused]] void add_variables(const std::vector<std::string> &identifiers,
-                       const std::vector<CseNode> &values);
-
-    void add_list(const std::string &identifier, const std::vector<CseNode>& list_elements);
+    /**
+     * Creates a machine whose Print writes to the given stream.
+     *
+     * @param out: The stream for the program's output; standard output by default.
+     */
+    explicit CSE(std::ostream &out = std::cout) : out(out) {}
 
-    // add lambda to environment
-    void add_lambda(const std::string &identifier, const CseNode &lambda);
+    /**
+     * Compile the RPAL program represented by the given Standardized Tree (ST) into bytecode.
+     *
+     * @param root: The root node of the ST.
+     */
+    void create_cs(TreeNode *root);
 
-    // get variable from environment
-    CseNode get_variable(const std::string &identifier);
+    /**
+     * The compiled program: one block of instructions for the program and for each lambda body.
+     */
+    [[nodiscard]] const Program &get_program() const;
 
-    // get lambda from environment
-    CseNode get_lambda(const std::string &identifier);
+    /**
+     * Run a program compiled elsewhere (e.g. loaded from the cache) instead of calling create_cs.
+     *
+     * @param compiled: The program, which must pass verifyProgram.
+     */
+    void set_program(Program compiled);
 
-    // get list from environment
-    std::vector<CseNode> get_list(const std::string &identifier);
-};
+    /**
+     * Evaluate the main control structure.
+     * This function implements the RPAL evaluation algorithm for the main control structure.
+     */
+    void evaluate();
 
-class CSE {
 private:
-    int next_env = 0;
-    int next_cs = -1;
+    /**
+     * Bind the argument on top of the stack to the variables of a closure in a new environment,
+     * and make that environment current.
+     *
+     * @param closure: The closure being applied.
+     */
+    void bind_arguments(const Value &closure);
 
-    std::vector<ControlStructure *> control_structures;
-    ControlStructure main_control_structure = ControlStructure(-1);
-    Stack stack = Stack();
-    std::vector<int> env_stack = std::vector<int>();
-    std::unordered_map<int, Env *> envs = std::unordered_map<int, Env *>();
+    /**
+     * The variable a closure binds, or NO_SYMBOL if it binds a tuple of variables.
+     */
+    [[nodiscard]] symbol_id bound_symbol(const Value &closure) const;
 
-public:
-    CSE() = default;
+    /**
+     * The text of a value, as the textbook machine compares it in eq and ne and writes it
+     * inside tuples.
+     */
+    [[nodiscard]] std::string value_text(const Value &value) const;
 
     /**
-     * Create control structures for the RPAL program represented by the given Abstract Syntax Tree (AST).
-     *
-     * @param root: The root node of the AST.
-     * @param current_cs: The current control structure being constructed.
-     * @param current_cs_index: The index of the current control structure in the control_structures vector.
+     * The integer an arithmetic operator or comparison reads from a value. Values other than
+     * integers are read from their text, so a string of digits counts as an integer. The
+     * operators only come here when their operands are not both inline integers or the result
+     * overflows 64 bits.
      */
-    void create_cs(TreeNode *root, ControlStructure *current_cs = nullptr, int current_cs_index = -1);
+    [[nodiscard]] BigInt integer_of(const Value &value) const;
 
     /**
-     * Evaluate the main control structure.
-     * This function implements the RPAL evaluation algorithm for the main control structure.
+     * Whether a value is the truth value true, as or, & and not test it.
      */
-    void evaluate();
+    [[nodiscard]] bool is_true(const Value &value) const;
+
+    /**
+     * Write a value the way Print shows it.
+     */
+    void print_value(const Value &value);
 };
 
 #endif //RPAL_FINAL_CSE_H
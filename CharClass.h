@@ -0,0 +1,68 @@
+#ifndef RPAL_FINAL_CHARCLASS_H
+#define RPAL_FINAL_CHARCLASS_H
+
+
+#include <array>
+#include <cstdint>
+
+
+/**
+ * Character class bits used by the lexer. A character may belong to several classes
+ * (e.g. '_' is both an operator symbol and an identifier continuation character).
+ */
+enum char_class : uint8_t
+{
+    CC_SPACE = 1 << 0,    // ' ', '\t', '\n', '\v', '\f', '\r'
+    CC_ALPHA = 1 << 1,    // Letters; the first character of an identifier
+    CC_DIGIT = 1 << 2,    // Decimal digits
+    CC_IDENT = 1 << 3,    // Letters, digits and '_'; the rest of an identifier
+    CC_OPERATOR = 1 << 4, // Operator symbols
+    CC_QUOTE = 1 << 5,    // '\'' and '"'
+    CC_PAREN = 1 << 6     // '(' and ')'
+};
+
+/**
+ * Builds the 256-entry character class table at compile time.
+ * @return The table, indexed by unsigned char.
+ */
+constexpr std::array<uint8_t, 256> makeCharClassTable()
+{
+    std::array<uint8_t, 256> table{};
+
+    for (int c = 'a'; c <= 'z'; c++)
+        table[c] |= CC_ALPHA | CC_IDENT;
+    for (int c = 'A'; c <= 'Z'; c++)
+        table[c] |= CC_ALPHA | CC_IDENT;
+    for (int c = '0'; c <= '9'; c++)
+        table[c] |= CC_DIGIT | CC_IDENT;
+    table['_'] |= CC_IDENT;
+
+    for (char c : {' ', '\t', '\n', '\v', '\f', '\r'})
+        table[static_cast<unsigned char>(c)] |= CC_SPACE;
+
+    for (const char *op = "+-*<>&.@/:=~|$!#%^_[}{?,"; *op != '\0'; op++)
+        table[static_cast<unsigned char>(*op)] |= CC_OPERATOR;
+
+    table['\''] |= CC_QUOTE;
+    table['"'] |= CC_QUOTE;
+    table['('] |= CC_PAREN;
+    table[')'] |= CC_PAREN;
+
+    return table;
+}
+
+inline constexpr std::array<uint8_t, 256> charClassTable = makeCharClassTable();
+
+/**
+ * Checks whether a character belongs to any of the given classes.
+ * @param c The character to check.
+ * @param mask A combination of char_class bits.
+ * @return True if the character is in at least one of the classes.
+ */
+inline bool hasCharClass(char c, uint8_t mask)
+{
+    return (charClassTable[static_cast<unsigned char>(c)] & mask) != 0;
+}
+
+
+#endif //RPAL_FINAL_CHARCLASS_H
@@ -0,0 +1,53 @@
+#ifndef RPAL_FINAL_COMPILATIONCONTEXT_H
+#define RPAL_FINAL_COMPILATIONCONTEXT_H
+
+
+#include <cstddef>
+#include <vector>
+
+#include "TokenStorage.h"
+#include "Tree.h"
+#include "TreeNode.h"
+
+/**
+ * @brief Holds the state of compiling one RPAL program.
+ *
+ * The parser and the standardizer keep everything they need here instead of in globals, so
+ * any number of programs can be compiled at the same time, each on its own thread with its
+ * own context. The only state shared between contexts is the process-wide SymbolTable,
+ * which is safe to use concurrently.
+ */
+class CompilationContext
+{
+public:
+    static constexpr size_t DEFAULT_PARSE_STACK_LIMIT = 64 * 1024 * 1024;
+
+    TokenStorage tokenStorage;         // Tokens of the program being parsed
+    std::vector<TreeNode *> nodeStack; // Subtrees built by the parser that have no parent yet
+    Tree tree;                         // The AST and ST roots of the program
+
+    // Bytes the parser may use for grammar rules waiting on a sub-rule; this bounds nesting depth
+    size_t parseStackLimit = DEFAULT_PARSE_STACK_LIMIT;
+
+    // Whether build_tree applies the standardization rules as it builds each node, so the parser
+    // produces the ST directly. Turn it off to keep the AST, e.g. to visualize it.
+    bool standardizeWhileParsing = true;
+
+    CompilationContext() = default;
+
+    /**
+     * Creates a context that reads its tokens from the given lexer.
+     * @param lexer The lexer of the program. It must outlive the parse.
+     */
+    explicit CompilationContext(Lexer &lexer)
+    {
+        tokenStorage.setLexer(lexer);
+    }
+
+    CompilationContext(const CompilationContext &) = delete;
+
+    CompilationContext &operator=(const CompilationContext &) = delete;
+};
+
+
+#endif //RPAL_FINAL_COMPILATIONCONTEXT_H
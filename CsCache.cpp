@@ -0,0 +1,334 @@
+#include "CsCache.h"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "SourceBuffer.h"
+
+/*
+ * File layout (native byte order, every section padded to 8 bytes):
+ *
+ *   CacheHeader
+ *   CachedBlock[blockCount]      where each block's instructions start in the code section
+ *   uint8_t[codeBytes]           the instructions of every block, back to back
+ *   uint32_t[constantCount]      string indices of Program::constants
+ *   uint32_t[symbolCount]        string indices of Program::symbols
+ *   CachedLambda[lambdaCount]
+ *   uint32_t[variableCount]      string indices of Program::variables
+ *   CachedString[stringCount]
+ *   char[stringBytes]            literals and symbol names, not terminated
+ */
+
+static constexpr char CACHE_MAGIC[8] = {'R', 'P', 'A', 'L', '-', 'C', 'S', '\0'};
+static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+static constexpr uint32_t NO_STRING = UINT32_MAX; // Stands for NO_SYMBOL
+
+struct CacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t sourceHash;
+    uint64_t sourceSize;
+    uint32_t blockCount;
+    uint32_t constantCount;
+    uint32_t symbolCount;
+    uint32_t lambdaCount;
+    uint32_t variableCount;
+    uint32_t stringCount;
+    uint64_t codeBytes;
+    uint64_t stringBytes;
+    uint64_t payloadHash; // FNV-1a over everything after the header, so damaged files are misses
+};
+
+struct CachedBlock
+{
+    uint64_t offset;
+    uint64_t length;
+};
+
+struct CachedLambda
+{
+    uint32_t body;
+    uint32_t number;
+    uint32_t firstVariable;
+    uint32_t variableCount;
+    uint32_t tuple;
+    uint32_t reserved;
+};
+
+struct CachedString
+{
+    uint32_t offset;
+    uint32_t length;
+};
+
+static_assert(std::is_trivially_copyable_v<CacheHeader> && sizeof(CacheHeader) == 80);
+static_assert(sizeof(CachedBlock) == 16 && sizeof(CachedLambda) == 24 && sizeof(CachedString) == 8);
+
+static size_t padded(size_t bytes)
+{
+    return (bytes + 7) & ~static_cast<size_t>(7);
+}
+
+static uint64_t fnv1a(std::string_view bytes)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (unsigned char c : bytes)
+    {
+        hash = (hash ^ c) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+CsCacheKey csCacheKey(std::string_view source)
+{
+    return {fnv1a(source), source.size()};
+}
+
+std::string csCachePath(const std::string &directory, const CsCacheKey &key)
+{
+    static const char *digits = "0123456789abcdef";
+    std::string name(16, '0');
+    for (int i = 15, shift = 0; i >= 0; --i, shift += 4)
+    {
+        name[i] = digits[(key.hash >> shift) & 0xf];
+    }
+    return (std::filesystem::path(directory) / (name + ".rpalcs")).string();
+}
+
+/**
+ * Reads the record at index within a section, if the whole record lies inside the file.
+ */
+template<typename T>
+static bool readRecord(std::string_view file, size_t sectionOffset, size_t index, T &record)
+{
+    size_t offset = sectionOffset + index * sizeof(T);
+    if (offset + sizeof(T) > file.size())
+    {
+        return false;
+    }
+    std::memcpy(&record, file.data() + offset, sizeof(T));
+    return true;
+}
+
+bool loadCachedProgram(const std::string &path, const CsCacheKey &key, CSE &cse)
+{
+    if (!std::filesystem::is_regular_file(path))
+    {
+        return false;
+    }
+
+    SourceBuffer mapping(path);
+    std::string_view file = mapping.view();
+
+    CacheHeader header{};
+    if (!mapping.isOpen() || !readRecord(file, 0, 0, header) ||
+        std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CS_CACHE_VERSION ||
+        header.byteOrder != BYTE_ORDER_MARK || header.sourceHash != key.hash || header.sourceSize != key.size ||
+        header.codeBytes > file.size() || header.stringBytes > file.size())
+    {
+        return false;
+    }
+
+    size_t blocksOffset = padded(sizeof(CacheHeader));
+    size_t codeOffset = blocksOffset + padded(size_t{header.blockCount} * sizeof(CachedBlock));
+    size_t constantsOffset = codeOffset + padded(header.codeBytes);
+    size_t symbolsOffset = constantsOffset + padded(size_t{header.constantCount} * sizeof(uint32_t));
+    size_t lambdasOffset = symbolsOffset + padded(size_t{header.symbolCount} * sizeof(uint32_t));
+    size_t variablesOffset = lambdasOffset + padded(size_t{header.lambdaCount} * sizeof(CachedLambda));
+    size_t stringsOffset = variablesOffset + padded(size_t{header.variableCount} * sizeof(uint32_t));
+    size_t bytesOffset = stringsOffset + padded(size_t{header.stringCount} * sizeof(CachedString));
+    if (bytesOffset + header.stringBytes != file.size() || fnv1a(file.substr(blocksOffset)) != header.payloadHash)
+    {
+        return false;
+    }
+
+    std::vector<std::string_view> strings(header.stringCount);
+    for (uint32_t i = 0; i < header.stringCount; ++i)
+    {
+        CachedString entry{};
+        if (!readRecord(file, stringsOffset, i, entry) || size_t{entry.offset} + entry.length > header.stringBytes)
+        {
+            return false;
+        }
+        strings[i] = file.substr(bytesOffset + entry.offset, entry.length);
+    }
+
+    // Symbol IDs only mean something within one process, so names are interned again
+    auto readSymbols = [&](size_t offset, uint32_t count, std::vector<symbol_id> &symbols) {
+        symbols.resize(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint32_t index;
+            if (!readRecord(file, offset, i, index) || (index != NO_STRING && index >= strings.size()))
+            {
+                return false;
+            }
+            symbols[i] = index == NO_STRING ? NO_SYMBOL : SymbolTable::getInstance().intern(strings[index]);
+        }
+        return true;
+    };
+
+    Program program;
+
+    program.blocks.resize(header.blockCount);
+    for (uint32_t i = 0; i < header.blockCount; ++i)
+    {
+        CachedBlock block{};
+        if (!readRecord(file, blocksOffset, i, block) || block.offset > header.codeBytes ||
+            block.length > header.codeBytes - block.offset)
+        {
+            return false;
+        }
+        const auto *code = reinterpret_cast<const uint8_t *>(file.data() + codeOffset + block.offset);
+        program.blocks[i].assign(code, code + block.length);
+    }
+
+    program.constants.resize(header.constantCount);
+    for (uint32_t i = 0; i < header.constantCount; ++i)
+    {
+        uint32_t index;
+        if (!readRecord(file, constantsOffset, i, index) || index >= strings.size())
+        {
+            return false;
+        }
+        program.constants[i] = std::string(strings[index]);
+    }
+
+    program.lambdas.resize(header.lambdaCount);
+    for (uint32_t i = 0; i < header.lambdaCount; ++i)
+    {
+        CachedLambda lambda{};
+        if (!readRecord(file, lambdasOffset, i, lambda))
+        {
+            return false;
+        }
+        program.lambdas[i] = {lambda.body, lambda.number, lambda.firstVariable, lambda.variableCount, lambda.tuple != 0};
+    }
+
+    if (!readSymbols(symbolsOffset, header.symbolCount, program.symbols) ||
+        !readSymbols(variablesOffset, header.variableCount, program.variables) || !verifyProgram(program))
+    {
+        return false;
+    }
+
+    cse.set_program(std::move(program));
+    return true;
+}
+
+bool saveCachedProgram(const std::string &path, const CsCacheKey &key, const CSE &cse)
+{
+    const Program &program = cse.get_program();
+
+    std::vector<CachedBlock> blocks;
+    std::string code;
+    std::vector<uint32_t> constants;
+    std::vector<uint32_t> symbols;
+    std::vector<CachedLambda> lambdas;
+    std::vector<uint32_t> variables;
+    std::vector<CachedString> strings;
+    std::string bytes;
+    std::unordered_map<std::string_view, uint32_t> stringIndices;
+
+    // Views point into the program's constants and the symbol table, which outlive this function
+    auto addString = [&](std::string_view text) {
+        auto [it, inserted] = stringIndices.try_emplace(text, static_cast<uint32_t>(strings.size()));
+        if (inserted)
+        {
+            strings.push_back({static_cast<uint32_t>(bytes.size()), static_cast<uint32_t>(text.size())});
+            bytes += text;
+        }
+        return it->second;
+    };
+
+    auto addSymbol = [&](symbol_id id) {
+        return id == NO_SYMBOL ? NO_STRING : addString(SymbolTable::getInstance().name(id));
+    };
+
+    for (const std::vector<uint8_t> &block : program.blocks)
+    {
+        blocks.push_back({code.size(), block.size()});
+        code.append(reinterpret_cast<const char *>(block.data()), block.size());
+    }
+    for (const std::string &constant : program.constants)
+    {
+        constants.push_back(addString(constant));
+    }
+    for (symbol_id symbol : program.symbols)
+    {
+        symbols.push_back(addSymbol(symbol));
+    }
+    for (const Lambda &lambda : program.lambdas)
+    {
+        lambdas.push_back({lambda.body, lambda.number, lambda.firstVariable, lambda.variableCount, lambda.tuple ? 1u : 0u, 0});
+    }
+    for (symbol_id variable : program.variables)
+    {
+        variables.push_back(addSymbol(variable));
+    }
+
+    CacheHeader header{};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CS_CACHE_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.sourceHash = key.hash;
+    header.sourceSize = key.size;
+    header.blockCount = static_cast<uint32_t>(blocks.size());
+    header.constantCount = static_cast<uint32_t>(constants.size());
+    header.symbolCount = static_cast<uint32_t>(symbols.size());
+    header.lambdaCount = static_cast<uint32_t>(lambdas.size());
+    header.variableCount = static_cast<uint32_t>(variables.size());
+    header.stringCount = static_cast<uint32_t>(strings.size());
+    header.codeBytes = code.size();
+    header.stringBytes = bytes.size();
+
+    std::string file;
+    auto append = [&file](const void *data, size_t size) {
+        file.append(static_cast<const char *>(data), size);
+        file.resize(padded(file.size()), '\0');
+    };
+    append(&header, sizeof(header));
+    append(blocks.data(), blocks.size() * sizeof(CachedBlock));
+    append(code.data(), code.size());
+    append(constants.data(), constants.size() * sizeof(uint32_t));
+    append(symbols.data(), symbols.size() * sizeof(uint32_t));
+    append(lambdas.data(), lambdas.size() * sizeof(CachedLambda));
+    append(variables.data(), variables.size() * sizeof(uint32_t));
+    append(strings.data(), strings.size() * sizeof(CachedString));
+    file += bytes;
+
+    header.payloadHash = fnv1a(std::string_view(file).substr(padded(sizeof(CacheHeader))));
+    std::memcpy(file.data(), &header, sizeof(header));
+    std::error_code error;
+    std::filesystem::path target(path);
+    if (target.has_parent_path())
+    {
+        std::filesystem::create_directories(target.parent_path(), error);
+    }
+
+    std::string temporary =
+            path + ".tmp" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out.write(file.data(), static_cast<std::streamsize>(file.size())) || !out.flush())
+        {
+            out.close();
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temporary, target, error);
+    if (error)
+    {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,78 @@
+#ifndef RPAL_FINAL_CSCACHE_H
+#define RPAL_FINAL_CSCACHE_H
+
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "CSE.h"
+
+
+/**
+ * Version of the cache file layout. Bump it whenever the layout or the bytecode changes, so
+ * stale cache files are ignored instead of misread.
+ */
+constexpr uint32_t CS_CACHE_VERSION = 5;
+
+/**
+ * @brief Identifies a program's source for the control structure cache.
+ *
+ * The hash is 64-bit FNV-1a over the source bytes; the size is checked as well, so two sources
+ * only share a cache file if both match.
+ */
+struct CsCacheKey
+{
+    uint64_t hash = 0;
+    uint64_t size = 0;
+};
+
+/**
+ * @brief Computes the cache key of a program's source.
+ * @param source The whole program text.
+ * @return The key under which its control structures are cached.
+ */
+CsCacheKey csCacheKey(std::string_view source);
+
+/**
+ * @brief Returns the path of the cache file for a key inside a cache directory.
+ * @param directory The cache directory.
+ * @param key The key returned by csCacheKey().
+ * @return The directory joined with the key's hash in hexadecimal and the .rpalcs extension.
+ */
+std::string csCachePath(const std::string &directory, const CsCacheKey &key);
+
+/**
+ * @brief Loads a cached program into a CSE machine, ready to evaluate.
+ *
+ * The file is memory-mapped and decoded in one pass into an ordinary Program, which the machine
+ * then owns: every block is copied out of the mapping, every literal becomes a std::string, and
+ * symbol names are interned again, since symbol IDs are only meaningful within one process. The
+ * whole payload is also hashed to reject damaged files. Loading is therefore linear in the size
+ * of the file rather than a bare mapping; what it saves is lexing, parsing, standardizing and
+ * compiling, and it keeps the mapping's lifetime out of the machine. A missing file, another
+ * layout version or byte order, a different source, or a truncated or malformed file are all
+ * treated as misses, and so is a program that does not pass verifyProgram().
+ *
+ * @param path The cache file.
+ * @param key The key of the source being run.
+ * @param cse The machine that receives the program; it is left untouched on a miss.
+ * @return True if the program was loaded, false on a miss.
+ */
+bool loadCachedProgram(const std::string &path, const CsCacheKey &key, CSE &cse);
+
+/**
+ * @brief Writes the program compiled by create_cs to a cache file.
+ *
+ * The file is written under a temporary name and renamed into place, so concurrent runs never
+ * see a partial file. Missing directories are created.
+ *
+ * @param path The cache file.
+ * @param key The key of the source the program was compiled from.
+ * @param cse The machine holding the program.
+ * @return True if the file was written, false otherwise.
+ */
+bool saveCachedProgram(const std::string &path, const CsCacheKey &key, const CSE &cse);
+
+
+#endif //RPAL_FINAL_CSCACHE_H
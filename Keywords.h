@@ -0,0 +1,196 @@
+#ifndef RPAL_FINAL_KEYWORDS_H
+#define RPAL_FINAL_KEYWORDS_H
+
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+#include "Token.h"
+
+
+/**
+ * A reserved word together with the token it is lexed as.
+ */
+struct KeywordEntry
+{
+    std::string_view word;
+    token_kind kind;
+    token_type type;
+};
+
+inline constexpr KeywordEntry keywordEntries[] = {
+        {"let", token_kind::KW_LET, token_type::KEYWORD},
+        {"where", token_kind::KW_WHERE, token_type::KEYWORD},
+        {"within", token_kind::KW_WITHIN, token_type::KEYWORD},
+        {"aug", token_kind::KW_AUG, token_type::KEYWORD},
+        {"fn", token_kind::KW_FN, token_type::KEYWORD},
+        {"in", token_kind::KW_IN, token_type::KEYWORD},
+        {"and", token_kind::OP_AND, token_type::OPERATOR},
+        {"or", token_kind::OP_OR, token_type::OPERATOR},
+        {"not", token_kind::OP_NOT, token_type::OPERATOR},
+        {"gr", token_kind::OP_GR, token_type::OPERATOR},
+        {"ge", token_kind::OP_GE, token_type::OPERATOR},
+        {"ls", token_kind::OP_LS, token_type::OPERATOR},
+        {"le", token_kind::OP_LE, token_type::OPERATOR},
+        {"eq", token_kind::OP_EQ, token_type::OPERATOR},
+        {"ne", token_kind::OP_NE, token_type::OPERATOR},
+        {"true", token_kind::KW_TRUE, token_type::INTEGER},
+        {"false", token_kind::KW_FALSE, token_type::INTEGER},
+        {"rec", token_kind::KW_REC, token_type::IDENTIFIER},
+        {"nil", token_kind::KW_NIL, token_type::IDENTIFIER},
+        {"dummy", token_kind::KW_DUMMY, token_type::IDENTIFIER}};
+
+constexpr size_t KEYWORD_COUNT = sizeof(keywordEntries) / sizeof(keywordEntries[0]);
+constexpr size_t KEYWORD_MIN_LENGTH = 2;
+constexpr size_t KEYWORD_MAX_LENGTH = 6;
+constexpr unsigned KEYWORD_TABLE_BITS = 6;
+constexpr size_t KEYWORD_TABLE_SIZE = size_t(1) << KEYWORD_TABLE_BITS;
+
+/**
+ * Hashes a word of at least KEYWORD_MIN_LENGTH characters from its length, first two and
+ * last characters, which is enough to tell the reserved words apart.
+ * @param word The word to hash.
+ * @param seed The seed that makes the hash perfect over keywordEntries.
+ * @return A slot index in [0, KEYWORD_TABLE_SIZE).
+ */
+constexpr uint32_t keywordHash(std::string_view word, uint32_t seed)
+{
+    uint32_t h = seed;
+    h = (h ^ static_cast<unsigned char>(word[0])) * 0x01000193u;
+    h = (h ^ static_cast<unsigned char>(word[1])) * 0x01000193u;
+    h = (h ^ static_cast<unsigned char>(word[word.size() - 1])) * 0x01000193u;
+    h = (h ^ static_cast<uint32_t>(word.size())) * 0x01000193u;
+    return h >> (32 - KEYWORD_TABLE_BITS);
+}
+
+/**
+ * Checks whether the given seed maps every reserved word to a distinct slot.
+ */
+constexpr bool isPerfectKeywordSeed(uint32_t seed)
+{
+    bool used[KEYWORD_TABLE_SIZE] = {};
+
+    for (const KeywordEntry &entry : keywordEntries)
+    {
+        uint32_t slot = keywordHash(entry.word, seed);
+        if (used[slot])
+            return false;
+        used[slot] = true;
+    }
+    return true;
+}
+
+/**
+ * Searches for the first seed that makes keywordHash perfect. Runs at compile time.
+ */
+constexpr uint32_t findKeywordSeed()
+{
+    for (uint32_t seed = 1; seed < 100000; seed++)
+    {
+        if (isPerfectKeywordSeed(seed))
+            return seed;
+    }
+    return 0;
+}
+
+inline constexpr uint32_t keywordSeed = findKeywordSeed();
+static_assert(keywordSeed != 0, "No perfect hash seed found for the reserved words");
+
+/**
+ * Builds the slot table: each slot holds an index into keywordEntries, or -1 if empty.
+ */
+constexpr std::array<int8_t, KEYWORD_TABLE_SIZE> makeKeywordSlots()
+{
+    std::array<int8_t, KEYWORD_TABLE_SIZE> slots{};
+
+    for (int8_t &slot : slots)
+        slot = -1;
+    for (size_t i = 0; i < KEYWORD_COUNT; i++)
+        slots[keywordHash(keywordEntries[i].word, keywordSeed)] = static_cast<int8_t>(i);
+
+    return slots;
+}
+
+inline constexpr std::array<int8_t, KEYWORD_TABLE_SIZE> keywordSlots = makeKeywordSlots();
+
+/**
+ * Looks a word up in the reserved word table with a single probe.
+ * @param word The identifier text.
+ * @return The matching entry, or nullptr if the word is not reserved.
+ */
+inline const KeywordEntry *findKeyword(std::string_view word)
+{
+    if (word.size() < KEYWORD_MIN_LENGTH || word.size() > KEYWORD_MAX_LENGTH)
+        return nullptr;
+
+    int8_t index = keywordSlots[keywordHash(word, keywordSeed)];
+    if (index < 0 || keywordEntries[index].word != word)
+        return nullptr;
+
+    return &keywordEntries[index];
+}
+
+/**
+ * Classifies the text of an operator token.
+ * @param op The operator text, e.g. "->" or "+".
+ * @return The operator's kind, or token_kind::NONE for symbol runs the grammar does not use.
+ */
+inline token_kind classifySymbol(std::string_view op)
+{
+    if (op.size() == 1)
+    {
+        switch (op[0])
+        {
+            case '=':
+                return token_kind::OP_ASSIGN;
+            case ',':
+                return token_kind::OP_COMMA;
+            case '.':
+                return token_kind::OP_DOT;
+            case '|':
+                return token_kind::OP_BAR;
+            case '&':
+                return token_kind::OP_AMP;
+            case '+':
+                return token_kind::OP_PLUS;
+            case '-':
+                return token_kind::OP_MINUS;
+            case '*':
+                return token_kind::OP_TIMES;
+            case '/':
+                return token_kind::OP_DIVIDE;
+            case '@':
+                return token_kind::OP_AT;
+            case '>':
+                return token_kind::OP_GR;
+            case '<':
+                return token_kind::OP_LS;
+            default:
+                return token_kind::NONE;
+        }
+    }
+    else if (op.size() == 2)
+    {
+        switch (op[0])
+        {
+            case '-':
+                return op[1] == '>' ? token_kind::OP_ARROW : token_kind::NONE;
+            case '*':
+                return op[1] == '*' ? token_kind::OP_POWER : token_kind::NONE;
+            case '>':
+                return op[1] == '=' ? token_kind::OP_GE : token_kind::NONE;
+            case '<':
+                return op[1] == '=' ? token_kind::OP_LE : token_kind::NONE;
+            case '!':
+                return op[1] == '=' ? token_kind::OP_NE : token_kind::NONE;
+            default:
+                return token_kind::NONE;
+        }
+    }
+
+    return token_kind::NONE;
+}
+
+
+#endif //RPAL_FINAL_KEYWORDS_H
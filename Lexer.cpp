@@ -3,141 +3,131 @@
 //
 
 #include "Lexer.h"
+#include "CharClass.h"
+#include "Keywords.h"
 
-std::unordered_set<std::string> keywords = {
-        "let", "where", "within", "aug", "fn", "in"};
-
-std::unordered_set<std::string> operators = {
-        "and", "or", "not", "gr", "ge", "ls", "le", "eq", "ne"};
-
-std::unordered_set<std::string> booleanValues = {
-        "true", "false"};
-
-// NOLINTNEXTLINE
 Token Lexer::getNextToken() {
-    skipWhitespace();
+    for (;;) {
+        skipWhitespace();
 
-    if (currentPosition >= input.length()) {
-        // Check if it is the last empty line or end of input
-        if (currentPosition == input.length())
+        if (currentPosition >= input.length()) {
             return {token_type::END_OF_FILE, ""};
-        else
-            return {token_type::DELIMITER, ""};
-    }
+        }
 
-    char currentChar = input[currentPosition++];
+        size_t start = currentPosition;
+        char currentChar = input[currentPosition++];
+        uint8_t currentClass = charClassTable[static_cast<unsigned char>(currentChar)];
 
-    if (isalpha(currentChar)) {
-        std::stringstream ss;
-        ss << currentChar;
-        while (currentPosition < input.length() && (isalnum(input[currentPosition]) || input[currentPosition] == '_')) {
-            ss << input[currentPosition++];
-        }
-        std::string identifier = ss.str();
-
-        // Check if the identifier is a keyword
-        if (keywords.count(identifier) > 0) {
-            return {token_type::KEYWORD, identifier};
-        } else if (operators.count(identifier) > 0) {
-            return {token_type::OPERATOR, identifier};
-        } else if (booleanValues.count(identifier) > 0) {
-            if (identifier == "true")
-                return {token_type::INTEGER, "1"};
-            else
-                return {token_type::INTEGER, "0"};
-        }
+        if (currentClass & CC_ALPHA) {
+            currentPosition = kernels.skipIdentifier(input.data(), currentPosition, input.length());
+            std::string_view identifier = input.substr(start, currentPosition - start);
 
-        return {token_type::IDENTIFIER, identifier};
-    } else if (isdigit(currentChar)) {
-        std::stringstream ss;
-        ss << currentChar;
-        while (currentPosition < input.length() && isdigit(input[currentPosition])) {
-            ss << input[currentPosition++];
-        }
-        std::string number = ss.str();
-        return {token_type::INTEGER, number};
-    } else if (currentChar == '/') {
-        if (currentPosition < input.length() && input[currentPosition] == '/') {
-            // Skip single-line comment
-            while (currentPosition < input.length() && input[currentPosition] != '\n') {
-                currentPosition++;
+            // Check if the identifier is a reserved word
+            const KeywordEntry *keyword = findKeyword(identifier);
+
+            if (keyword == nullptr) {
+                return {token_type::IDENTIFIER, identifier, token_kind::NONE,
+                        SymbolTable::getInstance().intern(identifier)};
+            } else if (keyword->kind == token_kind::KW_TRUE) {
+                return {token_type::INTEGER, "1", token_kind::KW_TRUE};
+            } else if (keyword->kind == token_kind::KW_FALSE) {
+                return {token_type::INTEGER, "0", token_kind::KW_FALSE};
+            } else if (keyword->type == token_type::IDENTIFIER) {
+                return {token_type::IDENTIFIER, identifier, keyword->kind,
+                        SymbolTable::getInstance().intern(identifier)};
             }
-            // Recursively call getNextToken to get the next valid token
-            return getNextToken();
-        } else if (isOperatorSymbol(currentChar)) {
-            std::stringstream ss;
-            ss << currentChar;
-            while (currentPosition < input.length() && isOperatorSymbol(input[currentPosition])) {
-                ss << input[currentPosition++];
+
+            return {keyword->type, identifier, keyword->kind};
+        } else if (currentClass & CC_DIGIT) {
+            currentPosition = scanWhile(currentPosition, CC_DIGIT);
+            return {token_type::INTEGER, input.substr(start, currentPosition - start)};
+        } else if (currentClass & CC_OPERATOR) {
+            if (currentChar == '/' && currentPosition < input.length() && input[currentPosition] == '/') {
+                // Skip single-line comment and continue with the next valid token
+                currentPosition = kernels.findNewline(input.data(), currentPosition, input.length());
+                continue;
+            } else if (currentChar == ',') {
+                return {token_type::OPERATOR, input.substr(start, 1), token_kind::OP_COMMA};
             }
-            std::string op = ss.str();
-            return {token_type::OPERATOR, op};
+
+            currentPosition = scanWhile(currentPosition, CC_OPERATOR);
+            std::string_view op = input.substr(start, currentPosition - start);
+            return {token_type::OPERATOR, op, classifySymbol(op)};
+        } else if (currentClass & CC_QUOTE) {
+            return {token_type::STRING, scanString(currentChar)};
+        } else if (currentClass & CC_PAREN) {
+            return {token_type::DELIMITER, input.substr(start, 1),
+                    currentChar == '(' ? token_kind::DL_OPEN_PAREN : token_kind::DL_CLOSE_PAREN};
         } else {
-            std::cerr << "Error: Unknown token encountered" << std::endl;
+            diagnostics << "Error: Unknown token encountered" << std::endl;
             return {token_type::END_OF_FILE, ""};
         }
-    } else if (isOperatorSymbol(currentChar)) {
-        std::stringstream ss;
-        ss << currentChar;
+    }
+}
 
-        if (ss.str() == ",") {
-            return {token_type::OPERATOR, ss.str()};
-        }
+std::string_view Lexer::scanString(char quote) {
+    size_t start = currentPosition;
 
-        while (currentPosition < input.length() && isOperatorSymbol(input[currentPosition])) {
-            ss << input[currentPosition++];
-        }
-        std::string op = ss.str();
-        return {token_type::OPERATOR, op};
-    } else if (currentChar == '\'' || currentChar == '"') {
-        bool isSingleQuote = currentChar == '\'';
+    // Fast path: literals without escapes are returned as a view into the input
+    while (currentPosition < input.length() && input[currentPosition] != quote && input[currentPosition] != '\\') {
+        currentPosition++;
+    }
 
-        std::stringstream ss;
-        while (currentPosition < input.length()) {
-            currentChar = input[currentPosition++];
-            if (currentChar == '\'' && isSingleQuote || currentChar == '"' && !isSingleQuote) {
+    if (currentPosition >= input.length() || input[currentPosition] == quote) {
+        std::string_view str = input.substr(start, currentPosition - start);
+        if (currentPosition < input.length())
+            currentPosition++; // Consume the closing quote
+        return str;
+    }
+
+    // Slow path: the literal contains escapes, so its unescaped text needs its own storage
+    std::string &str = unescapedStrings.emplace_back(input.substr(start, currentPosition - start));
+    while (currentPosition < input.length()) {
+        char currentChar = input[currentPosition++];
+        if (currentChar == quote) {
+            break;
+        } else if (currentChar == '\\') {
+            if (currentPosition >= input.length()) {
+                str += '\\';
                 break;
-            } else if (currentChar == '\\') {
-                currentChar = input[currentPosition++];
-                switch (currentChar) {
-                    case 't':
-                        ss << '\t';
-                        break;
-                    case 'n':
-                        ss << '\n';
-                        break;
-                    case '\\':
-                        ss << '\\';
-                        break;
-                    case '\'':
-                        ss << '\'';
-                        break;
-                    default:
-                        ss << '\\' << currentChar;
-                        break;
-                }
-            } else {
-                ss << currentChar;
             }
+
+            currentChar = input[currentPosition++];
+            switch (currentChar) {
+                case 't':
+                    str += '\t';
+                    break;
+                case 'n':
+                    str += '\n';
+                    break;
+                case '\\':
+                    str += '\\';
+                    break;
+                case '\'':
+                    str += '\'';
+                    break;
+                default:
+                    str += '\\';
+                    str += currentChar;
+                    break;
+            }
+        } else {
+            str += currentChar;
         }
-        std::string str = ss.str();
-        return {token_type::STRING, str};
-    } else if (currentChar == '(' || currentChar == ')') {
-        std::string delimiter(1, currentChar);
-        return {token_type::DELIMITER, delimiter};
-    } else {
-        std::cerr << "Error: Unknown token encountered" << std::endl;
-        return {token_type::END_OF_FILE, ""};
     }
+    return str;
 }
 
 void Lexer::skipWhitespace() {
-    while (currentPosition < input.length() && isspace(input[currentPosition])) {
-        currentPosition++;
-    }
+    currentPosition = kernels.skipWhitespace(input.data(), currentPosition, input.length());
 }
 
-bool Lexer::isOperatorSymbol(char c) {
-    static const std::string operators = "+-*<>&.@/:=~|$!#%^_[}{?,";
-    return operators.find(c) != std::string::npos;
+size_t Lexer::scanWhile(size_t position, uint8_t mask) const {
+    const char *data = input.data();
+    const size_t length = input.length();
+
+    while (position < length && (charClassTable[static_cast<unsigned char>(data[position])] & mask)) {
+        position++;
+    }
+    return position;
 }
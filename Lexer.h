@@ -7,29 +7,39 @@
 
 
 #include <string>
-#include <sstream>
+#include <string_view>
+#include <deque>
+#include <cstdint>
 #include <iostream>
-//#include <unordered_set>
 
 #include "Token.h"
-
-#include <unordered_set>
-#include <utility>
-//#include <sstream>
-//#include <iostream>
+#include "ScanKernels.h"
 
 
 /**
  * @brief The Lexer class tokenizes the input string.
+ *
+ * The lexer does not copy its input. Token values are views into the input, so the
+ * buffer passed to the constructor (usually a memory-mapped SourceBuffer) must outlive
+ * both the lexer and every token it returns.
  */
 class Lexer
 {
 public:
     /**
-     * @brief Constructs a Lexer object with the given input string.
-     * @param input The input string to tokenize.
+     * @brief Constructs a Lexer object over the given input.
+     * @param input The input to tokenize. It is not copied.
+     * @param kernels The routines used to skip whitespace, comments and identifier runs.
+     *                Defaults to defaultScanKernels().
+     * @param diagnostics The stream errors in the input are reported to; standard error by default.
      */
-    [[maybe_unused]] explicit Lexer(std::string input) : input(std::move(input)), currentPosition(0) {}
+    explicit Lexer(std::string_view input, const ScanKernels &kernels = defaultScanKernels(),
+                   std::ostream &diagnostics = std::cerr)
+            : input(input), currentPosition(0), kernels(kernels), diagnostics(diagnostics) {}
+
+    Lexer(const Lexer &) = delete;
+
+    Lexer &operator=(const Lexer &) = delete;
 
     /**
      * @brief Retrieves the next token from the input string.
@@ -44,15 +54,26 @@ private:
     void skipWhitespace();
 
     /**
-     * @brief Checks if the given character is an operator symbol.
-     * @param c The character to check.
-     * @return True if the character is an operator symbol, false otherwise.
+     * @brief Advances over a run of characters that belong to the given character classes.
+     * @param position The position to start scanning from.
+     * @param mask A combination of char_class bits (see CharClass.h).
+     * @return The position of the first character outside the classes, or the input length.
+     */
+    [[nodiscard]] size_t scanWhile(size_t position, uint8_t mask) const;
+
+    /**
+     * @brief Scans a string literal whose opening quote has already been consumed.
+     * @param quote The quote character that opened the literal.
+     * @return A view of the literal's contents.
      */
-    static bool isOperatorSymbol(char c);
+    std::string_view scanString(char quote);
 
 private:
-    std::string input;
+    std::string_view input;
     size_t currentPosition;
+    const ScanKernels &kernels;
+    std::ostream &diagnostics;
+    std::deque<std::string> unescapedStrings; // Owned text of string literals that contain escapes
 };
 
 #endif //RPAL_FINAL_LEXER_H
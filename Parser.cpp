@@ -4,9 +4,182 @@
 
 #include "Parser.h"
 
+#include <array>
+#include <cstdint>
+#include <string>
 
-void Parser::parse() {
-    TokenStorage &tokenStorage = TokenStorage::getInstance();
+
+/**
+ * The grammar rules that can be waiting on the parse stack. B stands for all of the operator
+ * layers B through Ap, which are parsed by one precedence climbing loop. Vb and Vl never
+ * contain an expression, so they are parsed by plain functions instead.
+ */
+enum class Rule : uint8_t
+{
+    E, Ew, T, Ta, Tc, B, R, Rn, D, Da, Dr, Db
+};
+
+/**
+ * Where a rule continues when the sub-rule it is waiting on has been parsed.
+ */
+enum ParseState : uint8_t
+{
+    START,            // The rule has not consumed anything yet
+    AFTER_ITEM,       // An operand or list item has been parsed
+    AFTER_OPERAND,    // The only operand of a unary construct (not, a sign, rec, where) has been parsed
+    AFTER_DEFINITION, // The D of "let D in E" or the D of "( D )" has been parsed
+    AFTER_BODY,       // The final E of "let", "fn" or "=" has been parsed
+    AFTER_CONDITION,  // The B of "B -> Tc | Tc" has been parsed
+    AFTER_THEN,       // The first Tc of "B -> Tc | Tc" has been parsed
+    AFTER_ELSE,       // The second Tc of "B -> Tc | Tc" has been parsed
+    AFTER_EXPRESSION  // The E of "( E )" has been parsed
+};
+
+/**
+ * Binding levels of the operator layers, loosest first. A level is also the grammar rule that
+ * parses operands at it: an operand parsed at LEVEL_BS may start with "not", and one parsed at
+ * LEVEL_A may start with a sign.
+ */
+enum Level : uint8_t
+{
+    LEVEL_B = 1, // or
+    LEVEL_BT,    // &
+    LEVEL_BS,    // not
+    LEVEL_BP,    // gr ge ls le eq ne
+    LEVEL_A,     // + -
+    LEVEL_AT,    // * /
+    LEVEL_AF,    // **
+    LEVEL_AP,    // @
+    LEVEL_R      // Application, which binds tighter than every operator
+};
+
+/**
+ * The node a binary operator token builds and the level it binds at. Tokens that are not
+ * binary operators have level 0.
+ */
+struct BindingPower
+{
+    NodeKind kind;
+    uint8_t level;
+};
+
+static constexpr size_t TOKEN_KIND_COUNT = static_cast<size_t>(token_kind::DL_CLOSE_PAREN) + 1;
+
+static constexpr std::array<BindingPower, TOKEN_KIND_COUNT> makeBindingPowers()
+{
+    std::array<BindingPower, TOKEN_KIND_COUNT> table{};
+
+    table[static_cast<size_t>(token_kind::OP_OR)] = {NodeKind::OR, LEVEL_B};
+    table[static_cast<size_t>(token_kind::OP_AMP)] = {NodeKind::AMP, LEVEL_BT};
+    table[static_cast<size_t>(token_kind::OP_GR)] = {NodeKind::GR, LEVEL_BP};
+    table[static_cast<size_t>(token_kind::OP_GE)] = {NodeKind::GE, LEVEL_BP};
+    table[static_cast<size_t>(token_kind::OP_LS)] = {NodeKind::LS, LEVEL_BP};
+    table[static_cast<size_t>(token_kind::OP_LE)] = {NodeKind::LE, LEVEL_BP};
+    table[static_cast<size_t>(token_kind::OP_EQ)] = {NodeKind::EQ, LEVEL_BP};
+    table[static_cast<size_t>(token_kind::OP_ASSIGN)] = {NodeKind::EQ, LEVEL_BP};
+    table[static_cast<size_t>(token_kind::OP_NE)] = {NodeKind::NE, LEVEL_BP};
+    table[static_cast<size_t>(token_kind::OP_PLUS)] = {NodeKind::PLUS, LEVEL_A};
+    table[static_cast<size_t>(token_kind::OP_MINUS)] = {NodeKind::MINUS, LEVEL_A};
+    table[static_cast<size_t>(token_kind::OP_TIMES)] = {NodeKind::TIMES, LEVEL_AT};
+    table[static_cast<size_t>(token_kind::OP_DIVIDE)] = {NodeKind::DIVIDE, LEVEL_AT};
+    table[static_cast<size_t>(token_kind::OP_POWER)] = {NodeKind::POWER, LEVEL_AF};
+    table[static_cast<size_t>(token_kind::OP_AT)] = {NodeKind::AT, LEVEL_AP};
+    return table;
+}
+
+static constexpr std::array<BindingPower, TOKEN_KIND_COUNT> BINDING_POWERS = makeBindingPowers();
+
+/**
+ * A grammar rule waiting for a sub-rule to be parsed. n is a count or a pending node kind,
+ * depending on the rule.
+ */
+struct ParseFrame
+{
+    Rule rule;
+    ParseState state;
+    uint8_t minLevel; // B only: the loosest operator level this operand may take
+    uint8_t maxLevel; // B only: the loosest operator level its left operand still accepts
+    int32_t n;
+};
+
+static constexpr int32_t NO_OPERATOR = -1;
+
+/**
+ * Parses with an explicit stack of ParseFrames instead of the call stack, so the nesting depth
+ * of a program is limited by the heap rather than by the thread's stack size. Each rule is a
+ * step function that either finishes, or pushes its own continuation and the sub-rule it needs.
+ * The AST is built through build_tree exactly as the recursive descent parser built it.
+ */
+class ParseMachine
+{
+public:
+    ParseMachine(CompilationContext &ctx, size_t stackLimit)
+            : ctx(ctx), tokenStorage(ctx.tokenStorage), maxFrames(stackLimit / sizeof(ParseFrame)), stackLimit(stackLimit)
+    {
+    }
+
+    void run();
+
+private:
+    CompilationContext &ctx;
+    TokenStorage &tokenStorage;
+    std::vector<ParseFrame> stack;
+    size_t maxFrames;
+    size_t stackLimit;
+
+    ParseFrame next{}; // The rule to run next, kept off the stack since it would be popped right away
+    bool hasNext = false;
+
+    [[noreturn]] void throwNestedTooDeeply() const
+    {
+        throw std::runtime_error("Syntax Error: program is nested too deeply (parse stack limit of "
+                                 + std::to_string(stackLimit) + " bytes reached)");
+    }
+
+    void push(Rule rule, ParseState state, int32_t n, uint8_t minLevel = 0, uint8_t maxLevel = 0)
+    {
+        if (stack.size() >= maxFrames)
+        {
+            throwNestedTooDeeply();
+        }
+        stack.push_back({rule, state, minLevel, maxLevel, n});
+    }
+
+    /** Parses rule next; the current rule continues in state with n once it is done. */
+    void call(Rule rule, Rule caller, ParseState state, int32_t n = 0)
+    {
+        push(caller, state, n);
+        jump(rule);
+    }
+
+    /** Parses rule in place of the current rule, which has nothing left to do. */
+    void jump(Rule rule, uint8_t minLevel = LEVEL_B)
+    {
+        next = {rule, START, minLevel, 0, 0};
+        hasNext = true;
+    }
+
+    void E(const ParseFrame &frame);
+    void Ew(const ParseFrame &frame);
+    void T(const ParseFrame &frame);
+    void Ta(const ParseFrame &frame);
+    void Tc(const ParseFrame &frame);
+    void B(const ParseFrame &frame);
+    bool operand(uint8_t minLevel);
+    bool operators(uint8_t minLevel, uint8_t maxLevel);
+    void R(const ParseFrame &frame);
+    bool application(bool first);
+    void Rn(const ParseFrame &frame);
+    void Rn(const Token &top);
+    void D(const ParseFrame &frame);
+    void Da(const ParseFrame &frame);
+    void Dr(const ParseFrame &frame);
+    void Db(const ParseFrame &frame);
+};
+
+
+void Parser::parse(CompilationContext &ctx) {
+    TokenStorage &tokenStorage = ctx.tokenStorage;
     Token token = tokenStorage.top();
 
     // Check if the input token is the end of file token
@@ -16,13 +189,20 @@ void Parser::parse() {
     }
     else
     {
-        E(); // Start parsing the expression
+        ParseMachine(ctx, ctx.parseStackLimit).run(); // Parse the expression
 
         // Check if the next token is the end of file token
         if (tokenStorage.top().type == token_type::END_OF_FILE)
         {
-            // Set the root of the AST to the last node in the nodeStack
-            Tree::getInstance().setASTRoot(Parser::nodeStack.back());
+            // Set the root of the AST (or of the ST, if it was standardized) to the last node in the nodeStack
+            if (ctx.standardizeWhileParsing)
+            {
+                ctx.tree.setStandardizedRoot(ctx.nodeStack.back());
+            }
+            else
+            {
+                ctx.tree.setASTRoot(ctx.nodeStack.back());
+            }
             return; // Parsing completed, return from the function
         }
         else
@@ -32,672 +212,707 @@ void Parser::parse() {
     }
 }
 
-void build_tree(const std::string &label, const int &num, bool isLeaf, const std::string &value)
+void build_tree(CompilationContext &ctx, NodeKind kind, const int &num, bool isLeaf, std::string_view value)
 {
     TreeNode *node;
 
     // Create a leaf node if isLeaf is true, otherwise create an internal node
     if (isLeaf)
     {
-        node = new LeafNode(label, value);
+        node = ctx.tree.newLeafNode(kind, value);
     }
     else
     {
-        node = new InternalNode(label);
+        node = ctx.tree.newInternalNode(kind);
     }
 
-    // Add the children from the nodeStack to the newly created node
+    // Move the children from the nodeStack to the newly created node; the last one is on top,
+    // so prepending them one by one leaves them in source order
     for (int i = 0; i < num; i++)
     {
-        node->addChild(Parser::nodeStack.back());
-        Parser::nodeStack.pop_back();
+        node->prependChild(ctx.nodeStack.back());
+        ctx.nodeStack.pop_back();
     }
 
-    // Reverse the order of the children
-    node->reverseChildren();
+    // The children were standardized when they were built, so the node can be standardized now
+    if (ctx.standardizeWhileParsing && !isLeaf)
+    {
+        standardizeNode(node, ctx.tree);
+    }
 
     // Push the constructed node onto the nodeStack
-    Parser::nodeStack.push_back(node);
+    ctx.nodeStack.push_back(node);
 }
 
-
-/**
- * Parses the expression starting with E.
- * Handles the grammar rule E -> "let" D "in" E | "fn" Vb { Vb } "." E | Ew.
- * Constructs the Abstract Syntax Tree (AST) nodes and builds the tree accordingly.
- *
- * @throws std::runtime_error if a syntax error occurs.
- */
-// NOLINTNEXTLINE
-void E()
+void build_identifier(CompilationContext &ctx, symbol_id symbol)
 {
-    TokenStorage &tokenStorage = TokenStorage::getInstance();
+    ctx.nodeStack.push_back(ctx.tree.newIdentifier(symbol));
+}
 
-    // Check if the current token is "let"
-    if (tokenStorage.top().value == "let")
-    {
-        tokenStorage.pop();
-        D();
 
-        // Check if the next token is "in"
-        if (tokenStorage.top().value == "in")
-        {
-            tokenStorage.pop();
-            E();
-        }
-        else
-        {
-            throw std::runtime_error("Syntax Error: 'in' expected");
-        }
+void ParseMachine::run()
+{
+    jump(Rule::E);
 
-        // Build the "let" node with 2 children
-        build_tree("let", 2, false);
-    }
-        // Check if the current token is "fn"
-    else if (tokenStorage.top().value == "fn")
+    while (hasNext || !stack.empty())
     {
-        tokenStorage.pop();
-        int n = 0;
-
-        // Process identifiers until a non-identifier token is encountered
-        while (tokenStorage.top().type == token_type::IDENTIFIER)
+        ParseFrame frame;
+        if (hasNext)
         {
-            Vb();
-            n++;
+            frame = next;
+            hasNext = false;
         }
-
-        if (n == 0)
+        else
         {
-            throw std::runtime_error("Syntax Error: at least one identifier expected");
+            frame = stack.back();
+            stack.pop_back();
         }
 
-        // Check if the next token is "."
-        if (tokenStorage.top().value == ".")
+        switch (frame.rule)
         {
-            tokenStorage.pop();
-            E();
+            case Rule::E: E(frame); break;
+            case Rule::Ew: Ew(frame); break;
+            case Rule::T: T(frame); break;
+            case Rule::Ta: Ta(frame); break;
+            case Rule::Tc: Tc(frame); break;
+            case Rule::B: B(frame); break;
+            case Rule::R: R(frame); break;
+            case Rule::Rn: Rn(frame); break;
+            case Rule::D: D(frame); break;
+            case Rule::Da: Da(frame); break;
+            case Rule::Dr: Dr(frame); break;
+            case Rule::Db: Db(frame); break;
         }
-        else
-        {
-            throw std::runtime_error("Syntax Error: '.' expected");
-        }
-
-        // Build the "lambda" node with n+1 children
-        build_tree("lambda", n + 1, false);
     }
-    else
+}
+
+/**
+ * Parses the expression starting with E.
+ * Handles the grammar rule E -> "let" D "in" E | "fn" Vb { Vb } "." E | Ew.
+ * n is the number of "fn" variables, or 0 for "let".
+ *
+ * @throws std::runtime_error if a syntax error occurs.
+ */
+void ParseMachine::E(const ParseFrame &frame)
+{
+    switch (frame.state)
     {
-        Ew();
+        case START:
+            // Check if the current token is "let"
+            if (tokenStorage.top().kind == token_kind::KW_LET)
+            {
+                tokenStorage.pop();
+                call(Rule::D, Rule::E, AFTER_DEFINITION);
+            }
+                // Check if the current token is "fn"
+            else if (tokenStorage.top().kind == token_kind::KW_FN)
+            {
+                tokenStorage.pop();
+                int n = 0;
+
+                // Process identifiers until a non-identifier token is encountered
+                while (tokenStorage.top().type == token_type::IDENTIFIER)
+                {
+                    Vb(ctx);
+                    n++;
+                }
+
+                if (n == 0)
+                {
+                    throw std::runtime_error("Syntax Error: at least one identifier expected");
+                }
+
+                // Check if the next token is "."
+                if (tokenStorage.top().kind == token_kind::OP_DOT)
+                {
+                    tokenStorage.pop();
+                    call(Rule::E, Rule::E, AFTER_BODY, n);
+                }
+                else
+                {
+                    throw std::runtime_error("Syntax Error: '.' expected");
+                }
+            }
+            else
+            {
+                jump(Rule::Ew);
+            }
+            break;
+        case AFTER_DEFINITION:
+            // Check if the next token is "in"
+            if (tokenStorage.top().kind == token_kind::KW_IN)
+            {
+                tokenStorage.pop();
+                call(Rule::E, Rule::E, AFTER_BODY, 0);
+            }
+            else
+            {
+                throw std::runtime_error("Syntax Error: 'in' expected");
+            }
+            break;
+        case AFTER_BODY:
+            if (frame.n == 0)
+            {
+                // Build the "let" node with 2 children
+                build_tree(ctx, NodeKind::LET, 2, false);
+            }
+            else
+            {
+                // Build the "lambda" node with n+1 children
+                build_tree(ctx, NodeKind::LAMBDA, frame.n + 1, false);
+            }
+            break;
+        default:
+            break;
     }
 }
 
 /**
  * Parses the expression starting with Ew.
  * Handles the grammar rule Ew -> T [ "where" Dr ].
- * Constructs the Abstract Syntax Tree (AST) nodes and builds the tree accordingly.
  *
  * @throws std::runtime_error if a syntax error occurs.
  */
-// NOLINTNEXTLINE
-void Ew()
+void ParseMachine::Ew(const ParseFrame &frame)
 {
-    TokenStorage &tokenStorage = TokenStorage::getInstance();
-    T();
-
-    // Check if the next token is "where"
-    if (tokenStorage.top().value == "where")
+    switch (frame.state)
     {
-        tokenStorage.pop();
-        Dr();
-        build_tree("where", 2, false);
+        case START:
+            call(Rule::T, Rule::Ew, AFTER_ITEM);
+            break;
+        case AFTER_ITEM:
+            // Check if the next token is "where"
+            if (tokenStorage.top().kind == token_kind::KW_WHERE)
+            {
+                tokenStorage.pop();
+                call(Rule::Dr, Rule::Ew, AFTER_OPERAND);
+            }
+            break;
+        case AFTER_OPERAND:
+            build_tree(ctx, NodeKind::WHERE, 2, false);
+            break;
+        default:
+            break;
     }
 }
 
 /**
  * Parses the expression starting with T.
  * Handles the grammar rule T -> Ta { "," Ta }.
- * Constructs the Abstract Syntax Tree (AST) nodes and builds the tree accordingly.
+ * n is the number of items after the first.
  *
  * @throws std::runtime_error if a syntax error occurs.
  */
-// NOLINTNEXTLINE
-void T()
+void ParseMachine::T(const ParseFrame &frame)
 {
-    TokenStorage &tokenStorage = TokenStorage::getInstance();
-    Ta();
-    int n = 0;
-
-    // Process additional T expressions separated by commas
-    while (tokenStorage.top().value == ",")
+    switch (frame.state)
     {
-        tokenStorage.pop();
-        Ta();
-        n++;
-    }
-
-    if (n > 0)
-    {
-        build_tree("tau", n + 1, false);
+        case START:
+            call(Rule::Ta, Rule::T, AFTER_ITEM, 0);
+            break;
+        case AFTER_ITEM:
+            // Process additional T expressions separated by commas
+            if (tokenStorage.top().kind == token_kind::OP_COMMA)
+            {
+                tokenStorage.pop();
+                call(Rule::Ta, Rule::T, AFTER_ITEM, frame.n + 1);
+            }
+            else if (frame.n > 0)
+            {
+                build_tree(ctx, NodeKind::TAU, frame.n + 1, false);
+            }
+            break;
+        default:
+            break;
     }
 }
 
 /**
  * Parses the expression starting with Ta.
  * Handles the grammar rule Ta -> Tc { "aug" Tc }.
- * Constructs the Abstract Syntax Tree (AST) nodes and builds the tree accordingly.
+ * n is the operator waiting for its right operand, or NO_OPERATOR.
  *
  * @throws std::runtime_error if a syntax error occurs.
  */
-// NOLINTNEXTLINE
-void Ta()
+void ParseMachine::Ta(const ParseFrame &frame)
 {
-    TokenStorage &tokenStorage = TokenStorage::getInstance();
-    Tc();
-
-    // Process additional Tc expressions separated by "aug" keyword
-    while (tokenStorage.top().value == "aug")
+    switch (frame.state)
     {
-        tokenStorage.pop();
-        Tc();
-        build_tree("aug", 2, false);
+        case START:
+            call(Rule::Tc, Rule::Ta, AFTER_ITEM, NO_OPERATOR);
+            break;
+        case AFTER_ITEM:
+            if (frame.n != NO_OPERATOR)
+            {
+                build_tree(ctx, NodeKind::AUG, 2, false);
+            }
+
+            // Process additional Tc expressions separated by "aug" keyword
+            if (tokenStorage.top().kind == token_kind::KW_AUG)
+            {
+                tokenStorage.pop();
+                call(Rule::Tc, Rule::Ta, AFTER_ITEM, static_cast<int32_t>(NodeKind::AUG));
+            }
+            break;
+        default:
+            break;
     }
 }
 
 /**
  * Parses the expression starting with Tc.
  * Handles the grammar rule Tc -> B [ "->" Tc [ "|" Tc ] ].
- * Constructs the Abstract Syntax Tree (AST) nodes and builds the tree accordingly.
  *
  * @throws std::runtime_error if a syntax error occurs.
  */
-// NOLINTNEXTLINE
-void Tc()
+void ParseMachine::Tc(const ParseFrame &frame)
 {
-    TokenStorage &tokenStorage = TokenStorage::getInstance();
-    B();
-
-    // Check if the next token is "->"
-    if (tokenStorage.top().value == "->")
+    switch (frame.state)
     {
-        tokenStorage.pop();
-        Tc();
-
-        // Check if the next token is "|"
-        if (tokenStorage.top().value == "|")
-        {
-            tokenStorage.pop();
-            Tc();
-            build_tree("->", 3, false);
-        }
-        else
-        {
-            throw std::runtime_error("Syntax Error: '|' expected");
-        }
+        case START:
+            call(Rule::B, Rule::Tc, AFTER_CONDITION);
+            break;
+        case AFTER_CONDITION:
+            // Check if the next token is "->"
+            if (tokenStorage.top().kind == token_kind::OP_ARROW)
+            {
+                tokenStorage.pop();
+                call(Rule::Tc, Rule::Tc, AFTER_THEN);
+            }
+            break;
+        case AFTER_THEN:
+            // Check if the next token is "|"
+            if (tokenStorage.top().kind == token_kind::OP_BAR)
+            {
+                tokenStorage.pop();
+                call(Rule::Tc, Rule::Tc, AFTER_ELSE);
+            }
+            else
+            {
+                throw std::runtime_error("Syntax Error: '|' expected");
+            }
+            break;
+        case AFTER_ELSE:
+            build_tree(ctx, NodeKind::CONDITIONAL, 3, false);
+            break;
+        default:
+            break;
     }
 }
 
 /**
- * Parses the expression starting with B.
- * Handles the grammar rule B -> Bt { "or" Bt }.
- * Constructs the Abstract Syntax Tree (AST) nodes and builds the tree accordingly.
+ * Parses the operator layers with precedence climbing.
+ * Handles the grammar rules
+ *     B  -> Bt { "or" Bt }          Bt -> Bs { "&" Bs }          Bs -> "not" Bp | Bp
+ *     Bp -> A [ comparison A ]      A  -> [ + | - ] At { + At | - At }
+ *     At -> Af { * Af | / Af }      Af -> Ap { ** Ap }           Ap -> R { @ identifier R }
+ * as a single loop over BINDING_POWERS instead of one rule per level. All binary operators are
+ * left associative except the comparisons, which do not chain, and the prefix operators are
+ * only allowed where their rule could start, so the AST is the same as the layered rules build.
+ *
+ * Operands are parsed by direct calls, which nest at most once per level. Each call first
+ * pushes the frame that would resume it, and pops it again if the operand is complete, so an
+ * operand that needs the stack (a parenthesized expression) can suspend the whole chain.
+ * n is the operator waiting for its operand, or NO_OPERATOR.
  *
  * @throws std::runtime_error if a syntax error occurs.
  */
-// NOLINTNEXTLINE
-void B()
+void ParseMachine::B(const ParseFrame &frame)
 {
-    TokenStorage &tokenStorage = TokenStorage::getInstance();
-    Bt();
-
-    // Process additional Bt expressions separated by "or" keyword
-    while (tokenStorage.top().value == "or")
+    switch (frame.state)
     {
-        tokenStorage.pop();
-        Bt();
-        build_tree("or", 2, false);
+        case START:
+            operand(frame.minLevel);
+            break;
+        case AFTER_OPERAND:
+            if (frame.n != NO_OPERATOR)
+            {
+                build_tree(ctx, static_cast<NodeKind>(frame.n), 1, false);
+            }
+            operators(frame.minLevel, frame.maxLevel);
+            break;
+        case AFTER_ITEM:
+            if (frame.n != NO_OPERATOR)
+            {
+                auto kind = static_cast<NodeKind>(frame.n);
+                build_tree(ctx, kind, kind == NodeKind::AT ? 3 : 2, false);
+            }
+            operators(frame.minLevel, frame.maxLevel);
+            break;
+        default:
+            break;
     }
 }
 
 /**
- * Parses the expression starting with Bt.
- * Handles the grammar rule Bt -> Bs { "&" Bs }.
- * Constructs the Abstract Syntax Tree (AST) nodes and builds the tree accordingly.
- *
- * @throws std::runtime_error if a syntax error occurs.
+ * Parses an operand that may take operators from minLevel up, with its prefix operator if its
+ * rule allows one.
+ * @return False if the operand was suspended on the stack.
  */
-// NOLINTNEXTLINE
-void Bt()
+bool ParseMachine::operand(uint8_t minLevel)
 {
-    TokenStorage &tokenStorage = TokenStorage::getInstance();
-    Bs();
+    token_kind kind = tokenStorage.top().kind;
 
-    // Process additional Bs expressions separated by "&" keyword
-    while (tokenStorage.top().value == "&")
+    if (kind == token_kind::OP_NOT && minLevel <= LEVEL_BS)
     {
+        // "not" applies to a Bp, and the result only takes & and or
         tokenStorage.pop();
-        Bs();
-        build_tree("&", 2, false);
+        push(Rule::B, AFTER_OPERAND, static_cast<int32_t>(NodeKind::NOT), minLevel, LEVEL_BT);
+        if (!operand(LEVEL_BP))
+        {
+            return false;
+        }
+        stack.pop_back();
+        build_tree(ctx, NodeKind::NOT, 1, false);
+        return operators(minLevel, LEVEL_BT);
     }
-}
 
-/**
- * Parses the expression starting with Bs.
- * Handles the grammar rule Bs -> "not" Bp | Bp.
- * Constructs the Abstract Syntax Tree (AST) nodes and builds the tree accordingly.
- *
- * @throws std::runtime_error if a syntax error occurs.
- */
-// NOLINTNEXTLINE
-void Bs()
-{
-    TokenStorage &tokenStorage = TokenStorage::getInstance();
-    if (tokenStorage.top().value == "not")
+    if ((kind == token_kind::OP_PLUS || kind == token_kind::OP_MINUS) && minLevel <= LEVEL_A)
     {
+        // A sign applies to an At; a leading '+' builds nothing
         tokenStorage.pop();
-        Bp();
-        build_tree("not", 1, false);
-    }
-    else
-    {
-        Bp();
+        int32_t sign = kind == token_kind::OP_MINUS ? static_cast<int32_t>(NodeKind::NEG) : NO_OPERATOR;
+        push(Rule::B, AFTER_OPERAND, sign, minLevel, LEVEL_A);
+        if (!operand(LEVEL_AT))
+        {
+            return false;
+        }
+        stack.pop_back();
+        if (sign != NO_OPERATOR)
+        {
+            build_tree(ctx, NodeKind::NEG, 1, false);
+        }
+        return operators(minLevel, LEVEL_A);
     }
-}
 
-/**
- * Parses the expression starting with Bp.
- * Handles the grammar rule Bp -> A { comparison_operator A }.
- * Constructs the Abstract Syntax Tree (AST) nodes and builds the tree accordingly.
- *
- * @throws std::runtime_error if a syntax error occurs.
- */
-// NOLINTNEXTLINE
-void Bp()
-{
-    TokenStorage &tokenStorage = TokenStorage::getInstance();
-    A();
-
-    // Check for comparison operators
-    if (tokenStorage.top().value == "gr" || tokenStorage.top().value == ">")
+    push(Rule::B, AFTER_ITEM, NO_OPERATOR, minLevel, LEVEL_R);
+    if (!application(true))
     {
-        tokenStorage.pop();
-        A();
-        build_tree("gr", 2, false);
-    }
-    else if (tokenStorage.top().value == "ge" || tokenStorage.top().value == ">=")
-    {
-        tokenStorage.pop();
-        A();
-        build_tree("ge", 2, false);
-    }
-    else if (tokenStorage.top().value == "ls" || tokenStorage.top().value == "<")
-    {
-        tokenStorage.pop();
-        A();
-        build_tree("ls", 2, false);
-    }
-    else if (tokenStorage.top().value == "le" || tokenStorage.top().value == "<=")
-    {
-        tokenStorage.pop();
-        A();
-        build_tree("le", 2, false);
-    }
-    else if (tokenStorage.top().value == "eq" || tokenStorage.top().value == "=")
-    {
-        tokenStorage.pop();
-        A();
-        build_tree("eq", 2, false);
-    }
-    else if (tokenStorage.top().value == "ne" || tokenStorage.top().value == "!=")
-    {
-        tokenStorage.pop();
-        A();
-        build_tree("ne", 2, false);
+        return false;
     }
+    stack.pop_back();
+    return operators(minLevel, LEVEL_R);
 }
 
 /**
- * Parses the expression starting with A.
- * Handles the grammar rule A -> + At | - At | At { + At | - At }.
- * Constructs the Abstract Syntax Tree (AST) nodes and builds the tree accordingly.
- *
- * @throws std::runtime_error if a syntax error occurs.
+ * Applies operators to the operand on top of the nodeStack for as long as the next one binds
+ * at minLevel or tighter and no looser than maxLevel, the loosest level the operand accepts.
+ * @return False if a right operand was suspended on the stack.
  */
-// NOLINTNEXTLINE
-void A()
+bool ParseMachine::operators(uint8_t minLevel, uint8_t maxLevel)
 {
-    TokenStorage &tokenStorage = TokenStorage::getInstance();
-
-    // Check for unary plus operator
-    if (tokenStorage.top().value == "+")
-    {
-        tokenStorage.pop();
-        At();
-    }
-        // Check for unary minus operator
-    else if (tokenStorage.top().value == "-")
-    {
-        tokenStorage.pop();
-        At();
-        build_tree("neg", 1, false);
-    }
-    else
-    {
-        At();
-    }
-
-    // Check for addition and subtraction operators
-    while (tokenStorage.top().value == "+" || tokenStorage.top().value == "-")
+    while (true)
     {
-        if (tokenStorage.top().value == "+")
-        {
-            tokenStorage.pop();
-            At();
-            build_tree("+", 2, false);
-        }
-        else if (tokenStorage.top().value == "-")
+        const BindingPower &op = BINDING_POWERS[static_cast<size_t>(tokenStorage.top().kind)];
+        if (op.level == 0 || op.level < minLevel || op.level > maxLevel)
         {
-            tokenStorage.pop();
-            At();
-            build_tree("-", 2, false);
+            return true;
         }
-    }
-}
 
-/**
- * Parses the expression starting with At.
- * Handles the grammar rule At -> Af { * Af | / Af }.
- * Constructs the Abstract Syntax Tree (AST) nodes and builds the tree accordingly.
- *
- * @throws std::runtime_error if a syntax error occurs.
- */
-// NOLINTNEXTLINE
-void At()
-{
-    TokenStorage &tokenStorage = TokenStorage::getInstance();
-    Af();
+        tokenStorage.pop();
 
-    // Check for multiplication and division operators
-    while (tokenStorage.top().value == "*" || tokenStorage.top().value == "/")
-    {
-        if (tokenStorage.top().value == "*")
+        if (op.kind == NodeKind::AT)
         {
-            tokenStorage.pop();
-            Af();
-            build_tree("*", 2, false);
+            // Check for identifier token
+            if (tokenStorage.top().type == token_type::IDENTIFIER)
+            {
+                Token token = tokenStorage.pop();
+                build_identifier(ctx, token.symbol);
+            }
+            else
+            {
+                throw std::runtime_error("Syntax Error: Identifier expected");
+            }
         }
-        else if (tokenStorage.top().value == "/")
+
+        // Comparisons do not chain, so a comparison result only takes the looser operators
+        uint8_t resultLevel = op.level == LEVEL_BP ? static_cast<uint8_t>(LEVEL_BS) : op.level;
+        push(Rule::B, AFTER_ITEM, static_cast<int32_t>(op.kind), minLevel, resultLevel);
+
+        // The right operand only takes operators that bind tighter
+        bool complete = op.level + 1 == LEVEL_R ? application(true) : operand(op.level + 1);
+        if (!complete)
         {
-            tokenStorage.pop();
-            Af();
-            build_tree("/", 2, false);
+            return false;
         }
+        stack.pop_back();
+
+        build_tree(ctx, op.kind, op.kind == NodeKind::AT ? 3 : 2, false);
+        maxLevel = resultLevel;
     }
 }
 
 /**
- * Parses the expression starting with Af.
- * Handles the grammar rule Af -> Ap { ** Ap }.
- * Constructs the Abstract Syntax Tree (AST) nodes and builds the tree accordingly.
+ * Continues the expression starting with R after a parenthesized Rn.
+ * Handles the grammar rule R -> Rn { Rn }.
+ * n is 1 if the Rn was an argument rather than the function.
  *
  * @throws std::runtime_error if a syntax error occurs.
  */
-// NOLINTNEXTLINE
-void Af()
+void ParseMachine::R(const ParseFrame &frame)
 {
-    TokenStorage &tokenStorage = TokenStorage::getInstance();
-    Ap();
-
-    // Check for exponentiation operator
-    while (tokenStorage.top().value == "**")
+    if (frame.n != 0)
     {
-        tokenStorage.pop();
-        Ap();
-        build_tree("**", 2, false);
+        build_tree(ctx, NodeKind::GAMMA, 2, false);
     }
+    application(false);
 }
 
 /**
- * Parses the expression starting with Ap.
- * Handles the grammar rule Ap -> R { @ identifier R }.
- * Constructs the Abstract Syntax Tree (AST) nodes and builds the tree accordingly.
- *
- * @throws std::runtime_error if a syntax error occurs.
+ * Parses the Rn's of an R, building a gamma node for each argument. Leaves are parsed in
+ * place; only a parenthesized Rn goes through the stack.
+ * @param first Whether no Rn of the R has been parsed yet.
+ * @return False if a parenthesized Rn was suspended on the stack.
  */
-// NOLINTNEXTLINE
-void Ap()
+bool ParseMachine::application(bool first)
 {
-    TokenStorage &tokenStorage = TokenStorage::getInstance();
-    R();
-
-    // Check for function application operator
-    while (tokenStorage.top().value == "@")
+    while (true)
     {
-        tokenStorage.pop();
+        Token top = tokenStorage.top();
 
-        // Check for identifier token
-        if (tokenStorage.top().type == token_type::IDENTIFIER)
+        if (!first && !(top.type == token_type::IDENTIFIER || top.type == token_type::INTEGER || top.type == token_type::STRING || top.kind == token_kind::KW_TRUE || top.kind == token_kind::KW_FALSE || top.kind == token_kind::KW_NIL || top.kind == token_kind::DL_OPEN_PAREN || top.kind == token_kind::KW_DUMMY))
         {
-            Token token = tokenStorage.pop();
-            build_tree("identifier", 0, true, token.value);
+            return true;
         }
-        else
+
+        if (top.kind == token_kind::DL_OPEN_PAREN)
         {
-            throw std::runtime_error("Syntax Error: Identifier expected");
+            tokenStorage.pop();
+            push(Rule::R, AFTER_ITEM, first ? 0 : 1);
+            call(Rule::E, Rule::Rn, AFTER_EXPRESSION);
+            return false;
         }
 
-        R();
-        build_tree("@", 3, false);
+        Rn(top);
+        if (!first)
+        {
+            build_tree(ctx, NodeKind::GAMMA, 2, false);
+        }
+        first = false;
     }
 }
 
 /**
- * Parses the expression starting with R.
- * Handles the grammar rule R -> Rn { Rn }.
- * Constructs the Abstract Syntax Tree (AST) nodes and builds the tree accordingly.
+ * Parses the closing parenthesis of Rn -> ( E ) once the E has been parsed.
  *
  * @throws std::runtime_error if a syntax error occurs.
  */
-// NOLINTNEXTLINE
-void R()
+void ParseMachine::Rn(const ParseFrame &)
 {
-    TokenStorage &tokenStorage = TokenStorage::getInstance();
-    Rn();
-
-    Token top = tokenStorage.top();
-    while (top.type == token_type::IDENTIFIER || top.type == token_type::INTEGER || top.type == token_type::STRING || top.value == "true" || top.value == "false" || top.value == "nil" || top.value == "(" || top.value == "dummy")
+    if (tokenStorage.top().kind == token_kind::DL_CLOSE_PAREN)
     {
-        Rn();
-        top = tokenStorage.top();
-        build_tree("gamma", 2, false);
+        tokenStorage.pop();
+    }
+    else
+    {
+        throw std::runtime_error("Syntax Error: ')' expected");
     }
 }
 
 /**
- * Parses the expression starting with Rn.
- * Handles the grammar rule Rn -> identifier | integer | string | true | false | nil | ( E ) | dummy.
- * Constructs the Abstract Syntax Tree (AST) nodes and builds the tree accordingly.
+ * Parses an Rn that is not parenthesized.
+ * Handles the grammar rule Rn -> identifier | integer | string | true | false | nil | dummy.
+ * @param top The current token.
  *
  * @throws std::runtime_error if a syntax error occurs.
  */
-// NOLINTNEXTLINE
-void Rn()
+void ParseMachine::Rn(const Token &top)
 {
-    TokenStorage &tokenStorage = TokenStorage::getInstance();
-    Token top = tokenStorage.top();
-
     if (top.type == token_type::IDENTIFIER)
     {
         // Parse Identifier
         Token token = tokenStorage.pop();
-        build_tree("identifier", 0, true, token.value);
+        build_identifier(ctx, token.symbol);
     }
     else if (top.type == token_type::INTEGER)
     {
         // Parse Integer
         Token token = tokenStorage.pop();
-        build_tree("integer", 0, true, token.value);
+        build_tree(ctx, NodeKind::INTEGER, 0, true, token.value);
     }
     else if (top.type == token_type::STRING)
     {
         // Parse String
         Token token = tokenStorage.pop();
-        build_tree("string", 0, true, token.value);
+        build_tree(ctx, NodeKind::STRING, 0, true, token.value);
     }
-    else if (top.value == "true")
+    else if (top.kind == token_kind::KW_TRUE)
     {
         // Parse true
         tokenStorage.pop();
-        build_tree("true", 0, true);
+        build_tree(ctx, NodeKind::TRUE, 0, true);
     }
-    else if (top.value == "false")
+    else if (top.kind == token_kind::KW_FALSE)
     {
         // Parse false
         tokenStorage.pop();
-        build_tree("false", 0, true);
+        build_tree(ctx, NodeKind::FALSE, 0, true);
     }
-    else if (top.value == "nil")
+    else if (top.kind == token_kind::KW_NIL)
     {
         // Parse nil
         tokenStorage.pop();
-        build_tree("nil", 0, true);
+        build_tree(ctx, NodeKind::NIL, 0, true);
     }
-    else if (top.value == "(")
-    {
-        tokenStorage.pop();
-        E();
-        if (tokenStorage.top().value == ")")
-        {
-            tokenStorage.pop();
-        }
-        else
-        {
-            throw std::runtime_error("Syntax Error: ')' expected");
-        }
-    }
-    else if (top.value == "dummy")
+    else if (top.kind == token_kind::KW_DUMMY)
     {
         // Parse dummy
         tokenStorage.pop();
-        build_tree("dummy", 0, true);
+        build_tree(ctx, NodeKind::DUMMY, 0, true);
     }
     else
     {
-        throw std::runtime_error("Syntax Error: Identifier, Integer, String, 'true', 'false', 'nil', '(', 'dummy' expected\ngot: " + top.value);
+        throw std::runtime_error("Syntax Error: Identifier, Integer, String, 'true', 'false', 'nil', '(', 'dummy' expected\ngot: " + std::string(top.value));
     }
 }
 
 /**
  * Parses the expression starting with D.
  * Handles the grammar rule D -> Da [ within D ].
- * Constructs the Abstract Syntax Tree (AST) nodes and builds the tree accordingly.
+ * n is 1 once a "within" is waiting for its right side.
  *
  * @throws std::runtime_error if a syntax error occurs.
  */
-// NOLINTNEXTLINE
-void D()
+void ParseMachine::D(const ParseFrame &frame)
 {
-    TokenStorage &tokenStorage = TokenStorage::getInstance();
-    Da();
-
-    while (tokenStorage.top().value == "within")
+    switch (frame.state)
     {
-        tokenStorage.pop();
-        D();
-        build_tree("within", 2, false);
+        case START:
+            call(Rule::Da, Rule::D, AFTER_ITEM, 0);
+            break;
+        case AFTER_ITEM:
+            if (frame.n != 0)
+            {
+                build_tree(ctx, NodeKind::WITHIN, 2, false);
+            }
+
+            if (tokenStorage.top().kind == token_kind::KW_WITHIN)
+            {
+                tokenStorage.pop();
+                call(Rule::D, Rule::D, AFTER_ITEM, 1);
+            }
+            break;
+        default:
+            break;
     }
 }
 
 /**
  * Parses the expression starting with Da.
  * Handles the grammar rule Da -> Dr { and Dr }.
- * Constructs the Abstract Syntax Tree (AST) nodes and builds the tree accordingly.
+ * n is the number of definitions after the first.
  *
  * @throws std::runtime_error if a syntax error occurs.
  */
-// NOLINTNEXTLINE
-void Da()
+void ParseMachine::Da(const ParseFrame &frame)
 {
-    TokenStorage &tokenStorage = TokenStorage::getInstance();
-    Dr();
-    int n = 0;
-
-    while (tokenStorage.top().value == "and")
+    switch (frame.state)
     {
-        tokenStorage.pop();
-        Dr();
-        n++;
-    }
-    if (n > 0) {
-        build_tree("and", n + 1, false);
+        case START:
+            call(Rule::Dr, Rule::Da, AFTER_ITEM, 0);
+            break;
+        case AFTER_ITEM:
+            if (tokenStorage.top().kind == token_kind::OP_AND)
+            {
+                tokenStorage.pop();
+                call(Rule::Dr, Rule::Da, AFTER_ITEM, frame.n + 1);
+            }
+            else if (frame.n > 0)
+            {
+                build_tree(ctx, NodeKind::AND, frame.n + 1, false);
+            }
+            break;
+        default:
+            break;
     }
 }
 
 /**
  * Parses the expression starting with Dr.
  * Handles the grammar rule Dr -> rec Db | Db.
- * Constructs the Abstract Syntax Tree (AST) nodes and builds the tree accordingly.
  *
  * @throws std::runtime_error if a syntax error occurs.
  */
-// NOLINTNEXTLINE
-void Dr()
+void ParseMachine::Dr(const ParseFrame &frame)
 {
-    TokenStorage &tokenStorage = TokenStorage::getInstance();
-
-    if (tokenStorage.top().value == "rec")
+    switch (frame.state)
     {
-        tokenStorage.pop();
-        Db();
-        build_tree("rec", 1, false);
-    }
-    else
-    {
-        Db();
+        case START:
+            if (tokenStorage.top().kind == token_kind::KW_REC)
+            {
+                tokenStorage.pop();
+                call(Rule::Db, Rule::Dr, AFTER_OPERAND);
+            }
+            else
+            {
+                jump(Rule::Db);
+            }
+            break;
+        case AFTER_OPERAND:
+            build_tree(ctx, NodeKind::REC, 1, false);
+            break;
+        default:
+            break;
     }
 }
 
 /**
  * Parses the expression starting with Db.
  * Handles the grammar rule Db -> ( D ) | identifier Vl = E | Vb { , Vb } = E | epsilon.
- * Constructs the Abstract Syntax Tree (AST) nodes and builds the tree accordingly.
+ * n is the number of function parameters, or 0 for a plain "=".
  *
  * @throws std::runtime_error if a syntax error occurs.
  */
-// NOLINTNEXTLINE
-void Db()
+void ParseMachine::Db(const ParseFrame &frame)
 {
-    TokenStorage &tokenStorage = TokenStorage::getInstance();
+    switch (frame.state)
+    {
+        case START:
+            break;
+        case AFTER_DEFINITION:
+            if (tokenStorage.top().kind == token_kind::DL_CLOSE_PAREN)
+            {
+                tokenStorage.pop();
+            }
+            else
+            {
+                throw std::runtime_error("Syntax Error: ')' expected");
+            }
+            return;
+        case AFTER_BODY:
+            if (frame.n == 0)
+            {
+                build_tree(ctx, NodeKind::ASSIGN, 2, false);
+            }
+            else
+            {
+                build_tree(ctx, NodeKind::FCN_FORM, frame.n + 2, false);
+            }
+            return;
+        default:
+            return;
+    }
 
-    if (tokenStorage.top().value == "(")
+    if (tokenStorage.top().kind == token_kind::DL_OPEN_PAREN)
     {
         tokenStorage.pop();
-        D();
-
-        if (tokenStorage.top().value == ")")
-        {
-            tokenStorage.pop();
-        }
-        else
-        {
-            throw std::runtime_error("Syntax Error: ')' expected");
-        }
+        call(Rule::D, Rule::Db, AFTER_DEFINITION);
     }
     else if (tokenStorage.top().type == token_type::IDENTIFIER)
     {
         // Parse Identifier
         Token token = tokenStorage.pop();
-        build_tree("identifier", 0, true, token.value);
+        build_identifier(ctx, token.symbol);
 
-        if (tokenStorage.top().value == ",")
+        if (tokenStorage.top().kind == token_kind::OP_COMMA)
         {
             tokenStorage.pop();
-            Vl();
+            Vl(ctx);
 
-            if (tokenStorage.top().value == "=")
+            if (tokenStorage.top().kind == token_kind::OP_ASSIGN)
             {
                 tokenStorage.pop();
-                E();
-                build_tree("=", 2, false);
+                call(Rule::E, Rule::Db, AFTER_BODY, 0);
             }
             else
             {
@@ -708,51 +923,22 @@ void Db()
         {
             int n = 0;
 
-            while (tokenStorage.top().value != "=" && tokenStorage.top().type == token_type::IDENTIFIER)
+            while (tokenStorage.top().kind != token_kind::OP_ASSIGN && tokenStorage.top().type == token_type::IDENTIFIER)
             {
-                Vb();
+                Vb(ctx);
                 n++;
             }
 
-            if (tokenStorage.top().value == "(")
-            {
-                //                tokenStorage.pop();
-                //                while (tokenStorage.top().value != ")")
-                //                {
-                //                    Vb();
-                //                    if (tokenStorage.top().value == ",")
-                //                    {
-                //                        tokenStorage.pop();
-                //                    }
-                //                    else
-                //                    {
-                //                        n++;
-                //                        break;
-                //                    }
-                //                    n++;
-                //                }
-                //
-                //                if (tokenStorage.top().value == ")") {
-                //                    tokenStorage.pop();
-                //                }
-                //                else {
-                //                    throw std::runtime_error("Syntax Error: ')' expected");
-                //                }
-                Vb();
+            if (tokenStorage.top().kind == token_kind::DL_OPEN_PAREN)
+            {
+                Vb(ctx);
                 n++;
             }
 
-            if (n == 0 && tokenStorage.top().value == "=")
-            {
-                tokenStorage.pop();
-                E();
-                build_tree("=", 2, false);
-            }
-            else if (n != 0 && tokenStorage.top().value == "=")
+            if (tokenStorage.top().kind == token_kind::OP_ASSIGN)
             {
                 tokenStorage.pop();
-                E();
-                build_tree("fcn_form", n + 2, false);
+                call(Rule::E, Rule::Db, AFTER_BODY, n);
             }
             else
             {
@@ -773,42 +959,42 @@ void Db()
  *
  * @throws std::runtime_error if a syntax error occurs.
  */
-void Vb()
+void Vb(CompilationContext &ctx)
 {
-    TokenStorage &tokenStorage = TokenStorage::getInstance();
+    TokenStorage &tokenStorage = ctx.tokenStorage;
 
     if (tokenStorage.top().type == token_type::IDENTIFIER)
     {
         // Parse Identifier
         Token token = tokenStorage.pop();
-        build_tree("identifier", 0, true, token.value);
+        build_identifier(ctx, token.symbol);
     }
-    else if (tokenStorage.top().value == "(")
+    else if (tokenStorage.top().kind == token_kind::DL_OPEN_PAREN)
     {
         tokenStorage.pop();
 
-        if (tokenStorage.top().value == ")")
+        if (tokenStorage.top().kind == token_kind::DL_CLOSE_PAREN)
         {
             tokenStorage.pop();
-            build_tree("()", 0, true);
+            build_tree(ctx, NodeKind::EMPTY_PARENS, 0, true);
         }
         else if (tokenStorage.top().type == token_type::IDENTIFIER)
         {
             // Parse Identifier
             Token token = tokenStorage.pop();
-            build_tree("identifier", 0, true, token.value);
+            build_identifier(ctx, token.symbol);
 
-            if (tokenStorage.top().value == ",")
+            if (tokenStorage.top().kind == token_kind::OP_COMMA)
             {
                 tokenStorage.pop();
-                Vl();
+                Vl(ctx);
             }
             //            else
             //            {
             //                throw std::runtime_error("Syntax Error: ',' expected");
             //            }
 
-            if (tokenStorage.top().value == ")")
+            if (tokenStorage.top().kind == token_kind::DL_CLOSE_PAREN)
             {
                 tokenStorage.pop();
             }
@@ -835,26 +1021,30 @@ void Vb()
  *
  * @throws std::runtime_error if a syntax error occurs.
  */
-void Vl()
+void Vl(CompilationContext &ctx)
 {
-    TokenStorage &tokenStorage = TokenStorage::getInstance();
+    TokenStorage &tokenStorage = ctx.tokenStorage;
 
     if (tokenStorage.top().type == token_type::IDENTIFIER)
     {
         // Parse Identifier
         Token token = tokenStorage.pop();
-        build_tree("identifier", 0, true, token.value);
+        build_identifier(ctx, token.symbol);
 
         int n = 2;
-        while (tokenStorage.top().value == ",")
+        while (tokenStorage.top().kind == token_kind::OP_COMMA)
         {
             tokenStorage.pop();
+            if (tokenStorage.top().type != token_type::IDENTIFIER)
+            {
+                throw std::runtime_error("Syntax Error: Identifier expected");
+            }
             token = tokenStorage.pop();
-            build_tree("identifier", 0, true, token.value);
+            build_identifier(ctx, token.symbol);
             n++;
         }
 
-        build_tree(",", n, false);
+        build_tree(ctx, NodeKind::COMMA, n, false);
     }
     else
     {
@@ -862,5 +1052,3 @@ void Vl()
     }
 }
 
-
-std::vector<TreeNode *> Parser::nodeStack;
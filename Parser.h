@@ -11,42 +11,43 @@
 #include "TokenStorage.h"
 #include "Tree.h"
 #include "TreeNode.h"
+#include "CompilationContext.h"
 
 //#include <vector>
 
 
-void E();
-void Ew();
-void T();
-void Ta();
-void Tc();
-void B();
-void Bt();
-void Bs();
-void Bp();
-void A();
-void At();
-void Af();
-void Ap();
-void R();
-void Rn();
-void D();
-void Da();
-void Dr();
-void Db();
-void Vb();
-void Vl();
+/**
+ * Parses a variable binding: Vb -> identifier | ( ) | ( identifier Vl ).
+ * Bindings never contain an expression, so they are parsed directly rather than on the parse stack.
+ */
+void Vb(CompilationContext &ctx);
+
+/**
+ * Parses a variable list: Vl -> identifier { , identifier }.
+ */
+void Vl(CompilationContext &ctx);
 
 
 /**
- * Constructs a new TreeNode with the specified label, number of children, leaf status, and value.
- * Adds the constructed node to the nodeStack.
- * @param label The label of the node.
+ * Constructs a new TreeNode with the specified kind, number of children, leaf status, and value.
+ * Adds the constructed node to the nodeStack of the compilation.
+ * @param ctx The compilation the node belongs to.
+ * @param kind The kind of the node.
  * @param num The number of children the node will have.
  * @param isLeaf A boolean indicating whether the node is a leaf node or not.
- * @param value The value associated with the node (only applicable for leaf nodes).
+ * @param value The text of an integer or string leaf, copied into the tree's arena; identifiers go through build_identifier.
+ *
+ * If ctx.standardizeWhileParsing is set, the node is replaced by its standardized form before it is pushed.
  */
-void build_tree(const std::string &label, const int &num, bool isLeaf, const std::string &value = "");
+void build_tree(CompilationContext &ctx, NodeKind kind, const int &num, bool isLeaf, std::string_view value = {});
+
+
+/**
+ * Constructs a new identifier leaf node for the given symbol and adds it to the nodeStack.
+ * @param ctx The compilation the node belongs to.
+ * @param symbol The interned name of the identifier.
+ */
+void build_identifier(CompilationContext &ctx, symbol_id symbol);
 
 
 /**
@@ -55,12 +56,16 @@ void build_tree(const std::string &label, const int &num, bool isLeaf, const std
 class Parser
 {
 public:
-    static std::vector<TreeNode *> nodeStack;
-
     /**
-     * Parses the input tokens and constructs the Abstract Syntax Tree (AST).
+     * Parses the tokens of the given compilation and stores the Abstract Syntax Tree (AST) in its tree,
+     * or the Standardized Tree (ST) if ctx.standardizeWhileParsing is set.
+     *
+     * The grammar rules waiting on sub-rules are kept on a heap-allocated stack rather than the call
+     * stack, so deeply nested programs are limited by ctx.parseStackLimit instead of crashing.
+     * @param ctx The compilation to parse. Its token storage must already have a lexer.
+     * @throws std::runtime_error on a syntax error or when the parse stack limit is reached.
      */
-    static void parse();
+    static void parse(CompilationContext &ctx);
 };
 
 #endif //RPAL_FINAL_PARSER_H
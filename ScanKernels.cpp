@@ -0,0 +1,213 @@
+#include "ScanKernels.h"
+#include "CharClass.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define RPAL_SCAN_X86_64 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define RPAL_TARGET_AVX2
+#else
+#define RPAL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+/*
+ * Scalar kernels
+ */
+static size_t scalarSkipWhitespace(const char *data, size_t position, size_t length) {
+    while (position < length && hasCharClass(data[position], CC_SPACE)) {
+        position++;
+    }
+    return position;
+}
+
+static size_t scalarFindNewline(const char *data, size_t position, size_t length) {
+    while (position < length && data[position] != '\n') {
+        position++;
+    }
+    return position;
+}
+
+static size_t scalarSkipIdentifier(const char *data, size_t position, size_t length) {
+    while (position < length && hasCharClass(data[position], CC_IDENT)) {
+        position++;
+    }
+    return position;
+}
+
+const ScanKernels &scalarScanKernels() {
+    static const ScanKernels kernels = {"scalar", scalarSkipWhitespace, scalarFindNewline, scalarSkipIdentifier};
+    return kernels;
+}
+
+#ifdef RPAL_SCAN_X86_64
+
+static inline unsigned countTrailingZeros(unsigned mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+/*
+ * SSE2 kernels (16 bytes per step). SSE2 is part of the x86-64 baseline, so these
+ * need no runtime check.
+ */
+static inline __m128i sse2InRange(__m128i v, char low, char span) {
+    // Unsigned (v - low) <= span, computed with the unsigned minimum since SSE2 lacks unsigned compares
+    __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8(low));
+    return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(span)), shifted);
+}
+
+static inline __m128i sse2Whitespace(__m128i v) {
+    return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), sse2InRange(v, '\t', '\r' - '\t'));
+}
+
+static inline __m128i sse2Identifier(__m128i v) {
+    __m128i alpha = sse2InRange(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z' - 'a');
+    __m128i digit = sse2InRange(v, '0', '9' - '0');
+    return _mm_or_si128(_mm_or_si128(alpha, digit), _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+}
+
+static size_t sse2SkipWhitespace(const char *data, size_t position, size_t length) {
+    // Most runs between tokens are a single space, so check the first byte before vectorizing
+    if (position < length && !hasCharClass(data[position], CC_SPACE))
+        return position;
+
+    while (position + 16 <= length) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + position));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(sse2Whitespace(v))) ^ 0xFFFFu;
+        if (mask != 0)
+            return position + countTrailingZeros(mask);
+        position += 16;
+    }
+    return scalarSkipWhitespace(data, position, length);
+}
+
+static size_t sse2FindNewline(const char *data, size_t position, size_t length) {
+    while (position + 16 <= length) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + position));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))));
+        if (mask != 0)
+            return position + countTrailingZeros(mask);
+        position += 16;
+    }
+    return scalarFindNewline(data, position, length);
+}
+
+static size_t sse2SkipIdentifier(const char *data, size_t position, size_t length) {
+    while (position + 16 <= length) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + position));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(sse2Identifier(v))) ^ 0xFFFFu;
+        if (mask != 0)
+            return position + countTrailingZeros(mask);
+        position += 16;
+    }
+    return scalarSkipIdentifier(data, position, length);
+}
+
+const ScanKernels *sse2ScanKernels() {
+    static const ScanKernels kernels = {"sse2", sse2SkipWhitespace, sse2FindNewline, sse2SkipIdentifier};
+    return &kernels;
+}
+
+/*
+ * AVX2 kernels (32 bytes per step). Compiled for AVX2 regardless of the global flags and
+ * only selected after checking the CPU at runtime.
+ */
+RPAL_TARGET_AVX2 static inline __m256i avx2InRange(__m256i v, char low, char span) {
+    __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8(low));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(span)), shifted);
+}
+
+RPAL_TARGET_AVX2 static size_t avx2SkipWhitespace(const char *data, size_t position, size_t length) {
+    if (position < length && !hasCharClass(data[position], CC_SPACE))
+        return position;
+
+    while (position + 32 <= length) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + position));
+        __m256i space = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                                        avx2InRange(v, '\t', '\r' - '\t'));
+        unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(space));
+        if (mask != 0)
+            return position + countTrailingZeros(mask);
+        position += 32;
+    }
+    return scalarSkipWhitespace(data, position, length);
+}
+
+RPAL_TARGET_AVX2 static size_t avx2FindNewline(const char *data, size_t position, size_t length) {
+    while (position + 32 <= length) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + position));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))));
+        if (mask != 0)
+            return position + countTrailingZeros(mask);
+        position += 32;
+    }
+    return scalarFindNewline(data, position, length);
+}
+
+RPAL_TARGET_AVX2 static size_t avx2SkipIdentifier(const char *data, size_t position, size_t length) {
+    while (position + 32 <= length) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + position));
+        __m256i alpha = avx2InRange(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z' - 'a');
+        __m256i digit = avx2InRange(v, '0', '9' - '0');
+        __m256i ident = _mm256_or_si256(_mm256_or_si256(alpha, digit), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+        unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(ident));
+        if (mask != 0)
+            return position + countTrailingZeros(mask);
+        position += 32;
+    }
+    return scalarSkipIdentifier(data, position, length);
+}
+
+/**
+ * Checks whether the running CPU (and operating system) support AVX2.
+ */
+static bool cpuSupportsAvx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+const ScanKernels *avx2ScanKernels() {
+    static const ScanKernels kernels = {"avx2", avx2SkipWhitespace, avx2FindNewline, avx2SkipIdentifier};
+    static const bool supported = cpuSupportsAvx2();
+    return supported ? &kernels : nullptr;
+}
+
+#else
+
+const ScanKernels *sse2ScanKernels() {
+    return nullptr;
+}
+
+const ScanKernels *avx2ScanKernels() {
+    return nullptr;
+}
+
+#endif
+
+const ScanKernels &defaultScanKernels() {
+    // AVX2 is not chosen even where the CPU has it: the runs the lexer skips are mostly shorter
+    // than a few 32-byte steps, and scan_bench measures the AVX2 set slower than SSE2 on them
+    static const ScanKernels &kernels = sse2ScanKernels() ? *sse2ScanKernels() : scalarScanKernels();
+    return kernels;
+}
@@ -0,0 +1,55 @@
+#ifndef RPAL_FINAL_SCANKERNELS_H
+#define RPAL_FINAL_SCANKERNELS_H
+
+
+#include <cstddef>
+
+
+/**
+ * @brief A set of run-scanning routines used by the lexer.
+ *
+ * Each routine starts at `position` and returns the position of the first byte that
+ * ends the run, or `length` if the run reaches the end of the input. Vectorized
+ * implementations look at 16 (SSE2) or 32 (AVX2) bytes per step; the scalar set is
+ * used on other architectures and as the reference implementation.
+ */
+struct ScanKernels
+{
+    const char *name; // Human readable name of the instruction set ("scalar", "sse2", "avx2")
+
+    // Returns the position of the first byte that is not whitespace
+    size_t (*skipWhitespace)(const char *data, size_t position, size_t length);
+
+    // Returns the position of the next '\n'
+    size_t (*findNewline)(const char *data, size_t position, size_t length);
+
+    // Returns the position of the first byte that is not a letter, digit or '_'
+    size_t (*skipIdentifier)(const char *data, size_t position, size_t length);
+};
+
+/**
+ * @brief Returns the portable byte-at-a-time kernels.
+ */
+const ScanKernels &scalarScanKernels();
+
+/**
+ * @brief Returns the SSE2 kernels, or nullptr if they were not compiled in.
+ */
+const ScanKernels *sse2ScanKernels();
+
+/**
+ * @brief Returns the AVX2 kernels, or nullptr if they were not compiled in or the CPU lacks AVX2.
+ */
+const ScanKernels *avx2ScanKernels();
+
+/**
+ * @brief Returns the kernels the lexer uses by default: SSE2 where it was compiled in, otherwise
+ * the scalar set.
+ *
+ * The AVX2 set is only used when asked for explicitly, since it has not been measured faster than
+ * SSE2 on typical sources. The choice is made once, on first use.
+ */
+const ScanKernels &defaultScanKernels();
+
+
+#endif //RPAL_FINAL_SCANKERNELS_H
@@ -0,0 +1,112 @@
+#include "SourceBuffer.h"
+
+#include <fstream>
+#include <iterator>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SourceBuffer::SourceBuffer(const std::string &filename) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+        {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping != nullptr)
+            {
+                void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                CloseHandle(mapping);
+
+                if (view != nullptr)
+                {
+                    data = static_cast<const char *>(view);
+                    size = static_cast<size_t>(fileSize.QuadPart);
+                    mapped = true;
+                    open = true;
+                }
+            }
+        }
+        CloseHandle(file);
+    }
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        struct stat st{};
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+        {
+            void *view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (view != MAP_FAILED)
+            {
+                // The lexer walks the file front to back exactly once
+                madvise(view, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+                data = static_cast<const char *>(view);
+                size = static_cast<size_t>(st.st_size);
+                mapped = true;
+                open = true;
+            }
+        }
+        ::close(fd);
+    }
+#endif
+
+    if (!mapped)
+    {
+        open = readFallback(filename);
+    }
+}
+
+SourceBuffer::~SourceBuffer() {
+    unmap();
+}
+
+bool SourceBuffer::isOpen() const {
+    return open;
+}
+
+std::string_view SourceBuffer::view() const {
+    return {data, size};
+}
+
+bool SourceBuffer::readFallback(const std::string &filename) {
+    std::ifstream file(filename, std::ios::binary);
+
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    fallback.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data = fallback.data();
+    size = fallback.size();
+    return true;
+}
+
+void SourceBuffer::unmap() {
+    if (!mapped)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+#else
+    munmap(const_cast<char *>(data), size);
+#endif
+
+    mapped = false;
+    data = nullptr;
+    size = 0;
+}
@@ -0,0 +1,66 @@
+#ifndef RPAL_FINAL_SOURCEBUFFER_H
+#define RPAL_FINAL_SOURCEBUFFER_H
+
+
+#include <string>
+#include <string_view>
+
+
+/**
+ * @brief A read-only view of a source file.
+ *
+ * The file is memory-mapped whenever the platform allows it, so the lexer can hand out
+ * tokens that point straight into the mapped bytes instead of copying the whole input.
+ * If mapping fails (e.g. empty files or special files), the contents are read into an
+ * owned buffer instead and the same view interface is exposed.
+ */
+class SourceBuffer
+{
+public:
+    /**
+     * @brief Opens and maps the given file.
+     * @param filename The path of the file to map.
+     */
+    explicit SourceBuffer(const std::string &filename);
+
+    ~SourceBuffer();
+
+    SourceBuffer(const SourceBuffer &) = delete;
+
+    SourceBuffer &operator=(const SourceBuffer &) = delete;
+
+    /**
+     * @brief Checks whether the file could be opened.
+     * @return True if the file contents are available, false otherwise.
+     */
+    [[nodiscard]] bool isOpen() const;
+
+    /**
+     * @brief Returns a view of the whole file contents.
+     * @return A string_view that stays valid for the lifetime of the SourceBuffer.
+     */
+    [[nodiscard]] std::string_view view() const;
+
+private:
+    /**
+     * @brief Reads the file into the owned fallback buffer.
+     * @param filename The path of the file to read.
+     * @return True if the file could be read, false otherwise.
+     */
+    bool readFallback(const std::string &filename);
+
+    /**
+     * @brief Unmaps the file if it was mapped.
+     */
+    void unmap();
+
+private:
+    const char *data = nullptr; // Start of the mapped (or owned) contents
+    size_t size = 0;            // Number of bytes in the contents
+    bool mapped = false;        // Whether data points to a memory mapping
+    bool open = false;          // Whether the file could be opened at all
+    std::string fallback;       // Owned contents when the file could not be mapped
+};
+
+
+#endif //RPAL_FINAL_SOURCEBUFFER_H
@@ -0,0 +1,59 @@
+#include "SymbolTable.h"
+
+SymbolTable::SymbolTable() {
+    // Must match the order of predefined_symbol
+    for (const char *name : {"Print", "Order", "Y*", "Conc", "Stem", "Stern", "Isinteger", "Isstring", "Istuple",
+                             "Isempty", "ItoS", "nil", "dummy"})
+    {
+        intern(name);
+    }
+}
+
+SymbolTable &SymbolTable::getInstance() {
+    return instance;
+}
+
+symbol_id SymbolTable::intern(std::string_view name) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = ids.find(name);
+        if (it != ids.end())
+        {
+            return it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+
+    // Another thread may have interned the name while no lock was held
+    auto it = ids.find(name);
+    if (it != ids.end())
+    {
+        return it->second;
+    }
+
+    auto id = static_cast<symbol_id>(names.size());
+    const std::string &stored = names.emplace_back(name);
+    ids.emplace(stored, id);
+    return id;
+}
+
+const std::string &SymbolTable::name(symbol_id id) const {
+    static const std::string empty;
+
+    if (id == NO_SYMBOL)
+    {
+        return empty;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return names[id];
+}
+
+size_t SymbolTable::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return names.size();
+}
+
+
+SymbolTable SymbolTable::instance; // Initialize the static instance
@@ -0,0 +1,99 @@
+#ifndef RPAL_FINAL_SYMBOLTABLE_H
+#define RPAL_FINAL_SYMBOLTABLE_H
+
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+
+/**
+ * Dense integer ID of an interned identifier.
+ */
+using symbol_id = uint32_t;
+
+/**
+ * ID used by nodes that do not carry an identifier.
+ */
+constexpr symbol_id NO_SYMBOL = UINT32_MAX;
+
+/**
+ * Identifiers that are interned up front, so their IDs are compile-time constants.
+ * The built-in functions come first; IDs below BUILTIN_COUNT are exactly the built-ins.
+ */
+enum predefined_symbol : symbol_id
+{
+    SYM_PRINT,
+    SYM_ORDER,
+    SYM_Y_STAR,
+    SYM_CONC,
+    SYM_STEM,
+    SYM_STERN,
+    SYM_ISINTEGER,
+    SYM_ISSTRING,
+    SYM_ISTUPLE,
+    SYM_ISEMPTY,
+    SYM_ITOS,
+    BUILTIN_COUNT,
+
+    SYM_NIL = BUILTIN_COUNT,
+    SYM_DUMMY,
+    PREDEFINED_SYMBOL_COUNT
+};
+
+/**
+ * @brief Interns identifier names and hands out dense 32-bit IDs for them.
+ *
+ * Every identifier is interned once, when it is lexed. From then on the tree, the control
+ * structures and the environments only carry its ID, so comparing or looking up names is
+ * an integer operation. The name is only materialized again for output and error messages.
+ * The table is process-wide and IDs are never reused. It is shared by every compilation in the
+ * process, so interning and name lookups are safe to call from several threads at once.
+ */
+class SymbolTable
+{
+private:
+    static SymbolTable instance;                          // Singleton instance
+    std::deque<std::string> names;                        // Names indexed by ID; a deque keeps them in place
+    std::unordered_map<std::string_view, symbol_id> ids;  // Views into names
+    mutable std::shared_mutex mutex;                      // Guards names and ids
+
+    SymbolTable();
+
+public:
+    SymbolTable(const SymbolTable &) = delete;
+
+    SymbolTable &operator=(const SymbolTable &) = delete;
+
+    /**
+     * Returns the instance of the SymbolTable class.
+     * @return The singleton instance of the SymbolTable class.
+     */
+    static SymbolTable &getInstance();
+
+    /**
+     * Returns the ID of the given name, interning it if it has not been seen before.
+     * @param name The identifier name.
+     * @return The ID of the name.
+     */
+    symbol_id intern(std::string_view name);
+
+    /**
+     * Returns the name of an interned identifier.
+     * @param id The ID returned by intern(), or NO_SYMBOL.
+     * @return A reference to the name (empty for NO_SYMBOL), valid for the lifetime of the program.
+     */
+    const std::string &name(symbol_id id) const;
+
+    /**
+     * Returns the number of interned identifiers.
+     */
+    [[nodiscard]] size_t size() const;
+};
+
+
+#endif //RPAL_FINAL_SYMBOLTABLE_H
@@ -0,0 +1,45 @@
+#include "Text.h"
+
+#include <vector>
+
+
+Text::Text(std::string characters) :
+        flatCharacters(std::move(characters)), length(static_cast<uint32_t>(flatCharacters.size())), flat(true)
+{}
+
+Text::Text(Value left, Value right) :
+        left(std::move(left)), right(std::move(right)), flat(false)
+{
+    length = this->left.asText().size() - this->left.stringStart() +
+             this->right.asText().size() - this->right.stringStart();
+}
+
+void Text::flatten()
+{
+    std::string result;
+    result.reserve(length);
+
+    // Only flat texts are ever sliced, so a part that is still a concatenation starts at 0
+    std::vector<const Value *> parts = {&right, &left};
+    while (!parts.empty())
+    {
+        const Value *part = parts.back();
+        parts.pop_back();
+
+        Text &text = part->asText();
+        if (text.flat)
+        {
+            result.append(text.flatCharacters, part->stringStart(), std::string::npos);
+        }
+        else
+        {
+            parts.push_back(&text.right);
+            parts.push_back(&text.left);
+        }
+    }
+
+    flatCharacters = std::move(result);
+    flat = true;
+    left = Value();
+    right = Value();
+}
@@ -0,0 +1,87 @@
+#ifndef RPAL_FINAL_TEXT_H
+#define RPAL_FINAL_TEXT_H
+
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "Value.h"
+
+
+/**
+ * @brief The characters of strings, shared by every Value that refers to them.
+ *
+ * A text is either flat, holding its characters, or the concatenation of two strings made by
+ * Conc. A concatenation is only flattened when something reads its characters; from then on it
+ * keeps them and lets go of its two parts. A STRING value is a text and the offset its
+ * characters start at, so Stern shares its argument's text instead of copying it.
+ *
+ * The parts of a concatenation existed before it, so texts cannot form cycles.
+ */
+class Text : public Counted
+{
+public:
+    /**
+     * Concatenations with at most this many characters are copied into a flat text straight
+     * away, which is cheaper than a node that would have to be flattened later.
+     */
+    static constexpr uint32_t FLAT_LIMIT = 64;
+
+    explicit Text(std::string characters);
+
+    /**
+     * @brief Makes the concatenation of two strings.
+     * @param left, right STRING values; the text takes them over.
+     */
+    Text(Value left, Value right);
+
+    Text(const Text &) = delete;
+
+    Text &operator=(const Text &) = delete;
+
+    [[nodiscard]] uint32_t size() const
+    {
+        return length;
+    }
+
+    /**
+     * @brief Returns the characters, flattening the text first if it is a concatenation.
+     */
+    [[nodiscard]] std::string_view characters()
+    {
+        if (!flat)
+        {
+            flatten();
+        }
+        return flatCharacters;
+    }
+
+    /**
+     * @brief Hands the parts of a concatenation to drop before the text is deleted. Drop must
+     * release each and leave it empty, so long chains of concatenations are freed by the
+     * caller's loop instead of by recursion.
+     */
+    template<typename Drop>
+    void dismantle(Drop &drop)
+    {
+        drop(left);
+        drop(right);
+    }
+
+private:
+    /**
+     * @brief Writes out the characters of a concatenation. The parts are walked with an
+     * explicit stack, since a string built by Conc in a loop is a long chain of them.
+     */
+    void flatten();
+
+    std::string flatCharacters; // The characters; empty until a concatenation is flattened
+    Value left;                 // The first part of a concatenation not yet flattened
+    Value right;                // The second part of a concatenation not yet flattened
+    uint32_t length;            // Number of characters
+    bool flat;                  // Whether flatCharacters holds the characters
+};
+
+
+#endif //RPAL_FINAL_TEXT_H
@@ -5,7 +5,10 @@
 #ifndef RPAL_FINAL_TOKEN_H
 #define RPAL_FINAL_TOKEN_H
 
-#include <string>
+#include <string_view>
+#include <cstdint>
+
+#include "SymbolTable.h"
 
 /**
  * Enumeration of token types.
@@ -21,13 +24,73 @@ enum token_type
     END_OF_FILE // Represents the end of file token
 };
 
+/**
+ * Enumeration of reserved words, operators and delimiters.
+ *
+ * The lexer classifies each token once so the parser can branch on the kind instead of
+ * comparing token text. Symbolic comparison operators share the kind of their word form
+ * (">" is OP_GR, "<=" is OP_LE, ...), except "=" which is also used for definitions.
+ */
+enum class token_kind : uint8_t
+{
+    NONE, // Ordinary identifiers, integers and strings
+
+    // Keywords
+    KW_LET,
+    KW_WHERE,
+    KW_WITHIN,
+    KW_AUG,
+    KW_FN,
+    KW_IN,
+    KW_REC,   // Lexed as an identifier
+    KW_TRUE,  // Lexed as the integer 1
+    KW_FALSE, // Lexed as the integer 0
+    KW_NIL,   // Lexed as an identifier
+    KW_DUMMY, // Lexed as an identifier
+
+    // Word operators (and the symbols that share their meaning)
+    OP_AND,
+    OP_OR,
+    OP_NOT,
+    OP_GR, // gr, >
+    OP_GE, // ge, >=
+    OP_LS, // ls, <
+    OP_LE, // le, <=
+    OP_EQ, // eq
+    OP_NE, // ne, !=
+
+    // Symbol operators
+    OP_ASSIGN, // =
+    OP_COMMA,  // ,
+    OP_DOT,    // .
+    OP_ARROW,  // ->
+    OP_BAR,    // |
+    OP_AMP,    // &
+    OP_PLUS,   // +
+    OP_MINUS,  // -
+    OP_TIMES,  // *
+    OP_DIVIDE, // /
+    OP_POWER,  // **
+    OP_AT,     // @
+
+    // Delimiters
+    DL_OPEN_PAREN,
+    DL_CLOSE_PAREN
+};
+
 /**
  * Structure representing a token.
+ *
+ * The value is a span into the source buffer the lexer was created with, so tokens are
+ * cheap to copy and never own memory. The only exception is string literals containing
+ * escape sequences, whose unescaped text lives in storage owned by the lexer.
  */
 struct Token
 {
-    token_type type;   // The type of the token
-    std::string value; // The value of the token
+    token_type type;                      // The type of the token
+    std::string_view value;               // The value of the token
+    token_kind kind = token_kind::NONE;   // The reserved word, operator or delimiter the token stands for
+    symbol_id symbol = NO_SYMBOL;         // The interned name of identifier tokens
 };
 
 #endif //RPAL_FINAL_TOKEN_H
@@ -4,6 +4,8 @@
 
 #include "TokenStorage.h"
 
+#include <stdexcept>
+
 void TokenStorage::setTokens() {
     Token token;
     do
@@ -13,32 +15,69 @@ void TokenStorage::setTokens() {
     } while (token.type != token_type::END_OF_FILE);
 }
 
-TokenStorage &TokenStorage::getInstance() {
-    return instance;
+void TokenStorage::fill() {
+    Token &slot = window[lexed % LOOKAHEAD_SIZE];
+
+    if (lexed > 0 && window[(lexed - 1) % LOOKAHEAD_SIZE].type == token_type::END_OF_FILE)
+    {
+        slot = window[(lexed - 1) % LOOKAHEAD_SIZE];
+    }
+    else
+    {
+        slot = lexer->getNextToken();
+    }
+    lexed++;
 }
 
-void TokenStorage::setLexer(Lexer &lexer_) {
+void TokenStorage::setLexer(Lexer &lexer_, bool streaming_) {
     this->lexer = &lexer_;
-    setTokens();
+    this->streaming = streaming_;
+    tokens.clear();
+    head = 0;
+    lexed = 0;
+
+    if (!streaming)
+    {
+        setTokens();
+    }
     currentPosition = 0;
 }
 
 Token &TokenStorage::top() {
-    return tokens[currentPosition];
+    if (!streaming)
+    {
+        return tokens[currentPosition];
+    }
+
+    if (head == lexed)
+    {
+        fill();
+    }
+    return window[head % LOOKAHEAD_SIZE];
 }
 
 Token &TokenStorage::pop() {
-    return tokens[currentPosition++];
+    if (!streaming)
+    {
+        return tokens[currentPosition++];
+    }
+
+    Token &token = top();
+    head++;
+    return token;
 }
 
 [[maybe_unused]] void TokenStorage::reset() {
+    if (streaming)
+    {
+        throw std::logic_error("TokenStorage: cannot reset a streaming token source");
+    }
     currentPosition = 0;
 }
 
-void TokenStorage::destroyInstance() {
-    instance.lexer = nullptr;
-    instance.tokens.clear();
+void TokenStorage::clear() {
+    lexer = nullptr;
+    tokens.clear();
+    head = 0;
+    lexed = 0;
 }
-
-
-TokenStorage TokenStorage::instance; // Initialize the static instance
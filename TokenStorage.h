@@ -7,71 +7,82 @@
 
 
 #include "Lexer.h"
+#include <array>
 #include <vector>
 
 /**
  * The TokenStorage class is responsible for storing and managing tokens during parsing.
- * It implements the singleton pattern to ensure only one instance exists throughout the program.
+ * Each compilation owns its own instance (see CompilationContext).
+ *
+ * By default tokens are pulled from the lexer on demand: top() lexes the next token only when
+ * it is first looked at, and consumed tokens are kept in a small ring buffer. Parsing starts
+ * right away and token memory stays constant whatever the size of the input. The buffered
+ * mode lexes the whole input into a vector up front, which is only needed to reset().
  */
 class TokenStorage
 {
+public:
+    static constexpr size_t LOOKAHEAD_SIZE = 8; // Slots in the ring buffer; a power of two
+
 private:
-    static TokenStorage instance; // Singleton instance
-    std::vector<Token> tokens;    // Vector to store tokens
-    int currentPosition{};          // Current position in the tokens vector
+    std::vector<Token> tokens;    // Vector to store tokens (buffered mode)
+    int currentPosition{};          // Current position in the tokens vector (buffered mode)
     Lexer *lexer{};                 // Pointer to the lexer
 
-    // Private constructor to prevent instantiation
-    TokenStorage() {}
-
-    // Private destructor to prevent deletion of the instance
-    ~TokenStorage() = default;
+    bool streaming = true;                      // Whether tokens are lexed on demand
+    std::array<Token, LOOKAHEAD_SIZE> window{}; // Ring buffer of the most recently lexed tokens
+    size_t head = 0;                            // Number of tokens consumed so far
+    size_t lexed = 0;                           // Number of tokens pulled from the lexer so far
 
     /**
      * Retrieves tokens from the lexer and stores them in the tokens vector until the end of file token is encountered.
      */
     void setTokens();
 
+    /**
+     * Pulls the next token from the lexer into the ring buffer.
+     * Once the end of file token has been lexed it is repeated instead of calling the lexer again.
+     */
+    void fill();
+
 public:
-    // Private copy constructor and assignment operator to prevent copying
+    TokenStorage() = default;
+
     TokenStorage(const TokenStorage &) = delete;
 
     TokenStorage &operator=(const TokenStorage &) = delete;
 
     /**
-     * Returns the instance of the TokenStorage class.
-     * @return The singleton instance of the TokenStorage class.
-     */
-    static TokenStorage &getInstance();
-
-    /**
-     * Sets the lexer_ and initializes the tokens vector.
+     * Sets the lexer_ and prepares to hand out its tokens.
      * @param lexer_ The lexer_ object to set.
+     * @param streaming_ Whether to lex on demand (the default) or to lex the whole input now.
      */
-    void setLexer(Lexer &lexer_);
+    void setLexer(Lexer &lexer_, bool streaming_ = true);
 
     /**
-     * Returns a reference to the current token at the top of the tokens vector.
+     * Returns a reference to the current token.
      * @return A reference to the current token.
      */
     Token &top();
 
     /**
-     * Removes and returns the current token at the top of the tokens vector.
+     * Removes and returns the current token.
+     * In streaming mode the reference stays valid until LOOKAHEAD_SIZE more tokens have been read.
      * @return The current token.
      */
     Token &pop();
 
     /**
      * Resets the current position to the beginning of the tokens vector.
+     * @throws std::logic_error in streaming mode, where consumed tokens are not kept.
      */
     [[maybe_unused]] void reset();
 
     /**
      * Clears the tokens vector and sets the lexer to nullptr.
-     * This method should be called when the TokenStorage instance is no longer needed.
+     * This method should be called when the tokens are no longer needed.
      */
-    static void destroyInstance();
+    void clear();
 };
 
 
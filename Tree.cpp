@@ -4,12 +4,46 @@
 
 #include "Tree.h"
 
-Tree &Tree::getInstance() {
-    return *tree;
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+Arena &Tree::getArena() {
+    return arena;
+}
+
+TreeNode *Tree::newInternalNode(NodeKind kind) {
+    return arena.make<TreeNode>(kind);
+}
+
+TreeNode *Tree::newLeafNode(NodeKind kind, std::string_view value) {
+    if (kind == NodeKind::INTEGER || kind == NodeKind::STRING)
+    {
+        return TreeNode::newLiteral(arena, kind, value);
+    }
+    return arena.make<TreeNode>(kind);
+}
+
+TreeNode *Tree::newIdentifier(symbol_id symbol) {
+    return arena.make<TreeNode>(NodeKind::IDENTIFIER, symbol);
+}
+
+TreeNode *Tree::cloneNode(const TreeNode *node) {
+    if (node->getKind() == NodeKind::INTEGER || node->getKind() == NodeKind::STRING)
+    {
+        // A literal's text follows the node, so copying the node alone would lose it
+        return TreeNode::newLiteral(arena, node->getKind(), node->getValue());
+    }
+
+    TreeNode *clone = arena.make<TreeNode>(*node);
+    clone->setNextSibling(nullptr);
+    return clone;
 }
 
 void Tree::setASTRoot(TreeNode *r) {
     astRoot = r;
+    astBytes = arena.bytesUsed();
 }
 
 TreeNode *Tree::getASTRoot() {
@@ -20,384 +54,354 @@ void Tree::setSTRoot(TreeNode *r) {
     stRoot = r;
 }
 
+void Tree::setStandardizedRoot(TreeNode *r) {
+    stRoot = r;
+    stBytes = arena.bytesUsed();
+    standardizedWhileParsing = true;
+}
+
 TreeNode *Tree::getSTRoot() {
     return stRoot;
 }
 
 void Tree::releaseASTMemory() {
-    Tree &instance = getInstance();
-
-    if (instance.astRoot != nullptr)
+    if (astRoot != nullptr)
     {
-        if (instance.stRoot == nullptr)
+        if (stRoot == nullptr)
         {
-            instance.stRoot = instance.astRoot;
+            stRoot = astRoot;
         }
 
-        instance.astRoot = nullptr;
+        astRoot = nullptr;
     }
 }
 
 [[maybe_unused]] void Tree::releaseSTMemory() {
-    Tree &instance = getInstance();
-    TreeNode::releaseNodeMemory(instance.stRoot);
+    arena.reset();
+    astRoot = nullptr;
+    stRoot = nullptr;
 }
 
 void Tree::generate() {
+    if (standardizedWhileParsing)
+    {
+        return; // The parser already built the ST
+    }
+
     releaseASTMemory();
-    generateST(getInstance().stRoot, nullptr);
+    generateST(stRoot, nullptr, *this);
+    stBytes = arena.bytesUsed() - astBytes;
 }
 
-// NOLINTNEXTLINE
-void generateST(TreeNode *currentNode, TreeNode *parentNode)
-{
-    if (currentNode == nullptr)
+void Tree::writeMemoryReport(std::ostream &out) const {
+    if (standardizedWhileParsing)
     {
-        return; // If the current node is nullptr, exit the function
+        out << "Tree memory: parse and standardize " << stBytes << " bytes, " << arena.bytesReserved()
+            << " bytes reserved" << std::endl;
+        return;
     }
 
-    if (currentNode->getNumChildren() != 0)
+    out << "Tree memory: parse " << astBytes << " bytes, standardize " << stBytes << " bytes, "
+        << arena.bytesReserved() << " bytes reserved" << std::endl;
+}
+
+/**
+ * Turns node into a node of the given kind whose children are the given nodes, in order.
+ * The children's next sibling links are overwritten; node keeps its own.
+ */
+static void rewrite(TreeNode *node, NodeKind kind, std::initializer_list<TreeNode *> children)
+{
+    TreeNode *first = nullptr;
+    TreeNode *last = nullptr;
+
+    for (TreeNode *child : children)
     {
-        std::vector<TreeNode *> children = currentNode->getChildren(); // Get the children of the current node
-        for (TreeNode *child : children)
+        child->setNextSibling(nullptr);
+        if (last == nullptr)
         {
-            generateST(child, currentNode); // Recursively generate the syntax tree for each child
-            currentNode->removeChild(0);    // Remove the processed child from the current node
+            first = child;
         }
+        else
+        {
+            last->setNextSibling(child);
+        }
+        last = child;
     }
 
-    TreeNode *root_node; // Assign the current node as the root node of the syntax tree
+    node->setKind(kind);
+    node->setChildren(first);
+}
 
-    // Define a static vector of binary operators
-    static std::vector<std::string> binaryOperators = {
-            "+", "-", "*", "/", "**", "gr", "ge", "ls", "le", "aug", "or", "&", "eq", "ne"};
+/**
+ * Creates a node with the given children, linking them in order.
+ * Each child's next sibling link is overwritten, so a child must not be needed in its old position.
+ */
+static TreeNode *makeNode(Tree &tree, NodeKind kind, std::initializer_list<TreeNode *> children)
+{
+    TreeNode *node = tree.newInternalNode(kind);
+    rewrite(node, kind, children);
+    return node;
+}
 
-    if (currentNode->getLabel() == "let")
+void standardizeNode(TreeNode *currentNode, Tree &tree)
+{
+    switch (currentNode->getKind())
     {
-        if (currentNode->getNumChildren() == 2)
+        case NodeKind::LET:
+        case NodeKind::WHERE:
         {
-            std::vector<TreeNode *> children = currentNode->getChildren();
-
-            TreeNode *eq_node;
-            TreeNode *p_node;
+            const char *name = currentNode->getKind() == NodeKind::LET ? "let" : "where";
 
-            // Check if the first child is the "=" node
-            if (children[0]->getLabel() == "=")
+            if (currentNode->getNumChildren() != 2)
             {
-                eq_node = children[0];
-                p_node = children[1];
-            }
-                // Check if the second child is the "=" node
-            else if (children[1]->getLabel() == "=")
-            {
-                eq_node = children[1];
-                p_node = children[0];
-            }
-                // Throw an error if neither child is the "=" node
-            else
-            {
-                throw std::runtime_error("Error: let node does not have an = node as a child");
+                throw std::runtime_error(std::string("Error: ") + name + " node must have 2 children.");
             }
 
-            if (eq_node->getNumChildren() == 2)
-            {
-                TreeNode *lambda_node = new InternalNode("lambda");
-                TreeNode *gamma_node = new InternalNode("gamma");
-
-                TreeNode *var_node = eq_node->getChildren()[0];
-                TreeNode *expr_node = eq_node->getChildren()[1];
-
-                lambda_node->addChild(var_node);
-                lambda_node->addChild(p_node);
-
-                gamma_node->addChild(lambda_node);
-                gamma_node->addChild(expr_node);
-
-                root_node = gamma_node; // Assign the gamma_node as the new root node
-            }
-            else
-            {
-                throw std::runtime_error("Error: = node must only have 2 children.");
-            }
-        }
-        else
-        {
-            throw std::runtime_error("Error: let node must have 2 children.");
-        }
-    }
-    else if (currentNode->getLabel() == "where")
-    {
-        if (currentNode->getNumChildren() == 2)
-        {
-            std::vector<TreeNode *> children = currentNode->getChildren();
+            TreeNode *first = currentNode->getChild(0);
+            TreeNode *second = currentNode->getChild(1);
 
             TreeNode *eq_node;
             TreeNode *p_node;
 
-            // Check if the first child is the "=" node
-            if (children[0]->getLabel() == "=")
+            // The "=" node may be either child
+            if (first->getKind() == NodeKind::ASSIGN)
             {
-                eq_node = children[0];
-                p_node = children[1];
+                eq_node = first;
+                p_node = second;
             }
-                // Check if the second child is the "=" node
-            else if (children[1]->getLabel() == "=")
+            else if (second->getKind() == NodeKind::ASSIGN)
             {
-                eq_node = children[1];
-                p_node = children[0];
+                eq_node = second;
+                p_node = first;
             }
-                // Throw an error if neither child is the "=" node
             else
             {
-                throw std::runtime_error("Error: where node does not have an = node as a child");
+                throw std::runtime_error(std::string("Error: ") + name + " node does not have an = node as a child");
             }
 
-            if (eq_node->getNumChildren() == 2)
-            {
-                TreeNode *lambda_node = new InternalNode("lambda");
-                TreeNode *gamma_node = new InternalNode("gamma");
-
-                TreeNode *var_node = eq_node->getChildren()[0];
-                TreeNode *expr_node = eq_node->getChildren()[1];
-
-                lambda_node->addChild(var_node);
-                lambda_node->addChild(p_node);
-
-                gamma_node->addChild(lambda_node);
-                gamma_node->addChild(expr_node);
-
-                root_node = gamma_node; // Assign the gamma_node as the new root node
-            }
-            else
+            if (eq_node->getNumChildren() != 2)
             {
                 throw std::runtime_error("Error: = node must only have 2 children.");
             }
-        }
-        else
-        {
-            throw std::runtime_error("Error: where node must have 2 children.");
-        }
-    }
-    else if (currentNode->getLabel() == "fcn_form")
-    {
-        if (currentNode->getNumChildren() > 2)
-        {
-            std::vector<TreeNode *> children = currentNode->getChildren();
-
-            TreeNode *fcn_name_node = children.front();
-            // Remove fcn_name_node from children
-            children.erase(children.begin());
 
-            TreeNode *expr_node = children.back();
-            // Remove expr_node from children
-            children.pop_back();
+            TreeNode *var_node = eq_node->getChild(0);
+            TreeNode *expr_node = eq_node->getChild(1);
 
-            TreeNode *eq_node = new InternalNode("=");
+            // let X = E in P  =>  gamma (lambda X P) E, with the "=" node becoming the lambda
+            rewrite(eq_node, NodeKind::LAMBDA, {var_node, p_node});
+            rewrite(currentNode, NodeKind::GAMMA, {eq_node, expr_node});
+            return;
+        }
+        case NodeKind::FCN_FORM:
+        {
+            if (currentNode->getNumChildren() <= 2)
+            {
+                throw std::runtime_error("Error: fcn_form node must have more than 2 children.");
+            }
 
-            eq_node->addChild(fcn_name_node);
+            // P V1 ... Vn E  =>  = P (lambda V1 (... (lambda Vn E)))
+            std::vector<TreeNode *> children(currentNode->getChildren().begin(), currentNode->getChildren().end());
 
-            TreeNode *prev_node = eq_node;
-            for (TreeNode *child : children)
+            TreeNode *body = children.back();
+            for (size_t i = children.size() - 2; i >= 1; i--)
             {
-                TreeNode *lambda_node = new InternalNode("lambda");
-                lambda_node->addChild(child);
-                prev_node->addChild(lambda_node);
-                prev_node = lambda_node;
+                body = makeNode(tree, NodeKind::LAMBDA, {children[i], body});
             }
 
-            prev_node->addChild(expr_node);
-
-            root_node = eq_node; // Assign the eq_node as the new root node
+            rewrite(currentNode, NodeKind::ASSIGN, {children.front(), body});
+            return;
         }
-        else
+        case NodeKind::LAMBDA:
         {
-            throw std::runtime_error("Error: fcn_form node must have more than 2 children.");
-        }
-    } else if (currentNode->getLabel() == "lambda" && currentNode->getChildren()[0]->getLabel() != "," &&
-             currentNode->getChildren()[1]->getLabel() != ",")
-    {
-        if (currentNode->getNumChildren() >= 2)
-        {
-            std::vector<TreeNode *> children = currentNode->getChildren();
-
-            TreeNode *expr_node = children.back();
-            // Remove expr_node from children
-            children.pop_back();
+            int numChildren = currentNode->getNumChildren();
+            if (numChildren < 2)
+            {
+                throw std::runtime_error("Error: lambda node must have at least 2 children.");
+            }
 
-            TreeNode *head_lambda_node = new InternalNode("lambda");
+            TreeNode *first = currentNode->getChild(0);
+            TreeNode *second = currentNode->getChild(1);
 
-            TreeNode *prev_node = head_lambda_node;
-            for (TreeNode *child : children)
+            // Lambdas that bind a tuple of variables are left for the CSE machine, and a lambda
+            // with one variable is already standard
+            if (first->getKind() == NodeKind::COMMA || second->getKind() == NodeKind::COMMA || numChildren == 2)
             {
-                TreeNode *lambda_node = new InternalNode("lambda");
-                lambda_node->addChild(child);
-                prev_node->addChild(lambda_node);
-                prev_node = lambda_node;
+                return;
             }
 
-            prev_node->addChild(expr_node);
+            // lambda V1 ... Vn E  =>  lambda V1 (... (lambda Vn E))
+            std::vector<TreeNode *> children(currentNode->getChildren().begin(), currentNode->getChildren().end());
+
+            TreeNode *body = children.back();
+            for (size_t i = children.size() - 2; i >= 1; i--)
+            {
+                body = makeNode(tree, NodeKind::LAMBDA, {children[i], body});
+            }
 
-            root_node = head_lambda_node->getChildren()[0];
-            head_lambda_node->getChildren().erase(head_lambda_node->getChildren().begin());
-            delete head_lambda_node;
+            rewrite(currentNode, NodeKind::LAMBDA, {children.front(), body});
+            return;
         }
-        else
+        case NodeKind::WITHIN:
         {
-            throw std::runtime_error("Error: lambda node must have at least 2 children.");
-        }
-    }
-    else if (currentNode->getLabel() == "within")
-    {
-        if (currentNode->getNumChildren() == 2)
-        {
-            std::vector<TreeNode *> children = currentNode->getChildren();
+            if (currentNode->getNumChildren() != 2)
+            {
+                throw std::runtime_error("Error: within node must have 2 children.");
+            }
 
             // Check if each child is the "=" node and has exactly 2 children
-            for (TreeNode *child : children)
+            for (TreeNode *eq_child : currentNode->getChildren())
             {
-                if (child->getLabel() != "=")
+                if (eq_child->getKind() != NodeKind::ASSIGN)
                 {
                     throw std::runtime_error("Error: within node must have an = node as a child");
                 }
-                else if (child->getNumChildren() != 2)
+                else if (eq_child->getNumChildren() != 2)
                 {
                     throw std::runtime_error("Error: = node must have 2 children.");
                 }
             }
 
-            // Retrieve the two "=" nodes
-            TreeNode *first_eq_node = children[0];
-            TreeNode *second_eq_node = children[1];
-
-            // Create new nodes for constructing the modified syntax tree
-            TreeNode *new_eq_node = new InternalNode("=");
-            TreeNode *new_gamma_node = new InternalNode("gamma");
-            TreeNode *new_lambda_node = new InternalNode("lambda");
-
-            // Modify the new_eq_node and new_gamma_node
-            new_eq_node->addChild(second_eq_node->getChildren()[0]);
-            new_eq_node->addChild(new_gamma_node);
+            TreeNode *first_eq_node = currentNode->getChild(0);
+            TreeNode *second_eq_node = currentNode->getChild(1);
 
-            // Modify the new_gamma_node
-            new_gamma_node->addChild(new_lambda_node);
-            new_gamma_node->addChild(first_eq_node->getChildren()[1]);
+            TreeNode *x1 = first_eq_node->getChild(0);
+            TreeNode *e1 = first_eq_node->getChild(1);
+            TreeNode *x2 = second_eq_node->getChild(0);
+            TreeNode *e2 = second_eq_node->getChild(1);
 
-            // Modify the new_lambda_node
-            new_lambda_node->addChild(first_eq_node->getChildren()[0]);
-            new_lambda_node->addChild(second_eq_node->getChildren()[1]);
-
-            root_node = new_eq_node; // Assign the new_eq_node as the new root node
-        }
-        else
-        {
-            throw std::runtime_error("Error: within node must have 2 children.");
+            // X1 = E1 within X2 = E2  =>  = X2 (gamma (lambda X1 E2) E1)
+            rewrite(second_eq_node, NodeKind::LAMBDA, {x1, e2});
+            rewrite(first_eq_node, NodeKind::GAMMA, {second_eq_node, e1});
+            rewrite(currentNode, NodeKind::ASSIGN, {x2, first_eq_node});
+            return;
         }
-    } else if (currentNode->getLabel() == "@")
-    {
-        if (currentNode->getNumChildren() == 3)
+        case NodeKind::AT:
         {
-            std::vector<TreeNode *> children = currentNode->getChildren();
-
-            TreeNode *first_gamma_node = new InternalNode("gamma");
-            TreeNode *second_gamma_node = new InternalNode("gamma");
-
-            // Construct the first_gamma_node
-            first_gamma_node->addChild(second_gamma_node);
-            first_gamma_node->addChild(children[2]);
+            if (currentNode->getNumChildren() != 3)
+            {
+                throw std::runtime_error("Error: @ node must have 3 children.");
+            }
 
-            // Construct the second_gamma_node
-            second_gamma_node->addChild(children[1]);
-            second_gamma_node->addChild(children[0]);
+            TreeNode *e1 = currentNode->getChild(0);
+            TreeNode *n = currentNode->getChild(1);
+            TreeNode *e2 = currentNode->getChild(2);
 
-            root_node = first_gamma_node; // Assign the first_gamma_node as the new root node
+            // E1 @ N E2  =>  gamma (gamma N E1) E2
+            TreeNode *second_gamma_node = makeNode(tree, NodeKind::GAMMA, {n, e1});
+            rewrite(currentNode, NodeKind::GAMMA, {second_gamma_node, e2});
+            return;
         }
-        else
-        {
-            throw std::runtime_error("Error: @ node must have 3 children.");
-        }
-    }
-    else if (currentNode->getLabel() == "and")
-    {
-        if (currentNode->getNumChildren() >= 2)
+        case NodeKind::AND:
         {
-            std::vector<TreeNode *> children = currentNode->getChildren();
+            if (currentNode->getNumChildren() < 2)
+            {
+                throw std::runtime_error("Error: and node must have at least 2 children.");
+            }
 
-            TreeNode *eq_node = new InternalNode("=");
-            TreeNode *comma_node = new InternalNode(",");
-            TreeNode *tau_node = new InternalNode("tau");
+            // X1 = E1 and ... and Xn = En  =>  = (, X1 ... Xn) (tau E1 ... En),
+            // with the first two "=" nodes becoming the "," and tau nodes
+            TreeNode *comma_node = currentNode->getChild(0);
+            TreeNode *tau_node = currentNode->getChild(1);
+            TreeNode *first_var = nullptr;
+            TreeNode *first_expr = nullptr;
+            TreeNode *last_var = nullptr;
+            TreeNode *last_expr = nullptr;
+
+            TreeNode *eq_child = currentNode->getFirstChild();
+            while (eq_child != nullptr)
+            {
+                TreeNode *next = eq_child->getNextSibling();
+                TreeNode *var_node = eq_child->getChild(0);
+                TreeNode *expr_node = eq_child->getChild(1);
 
-            // Construct the eq_node and its children
-            eq_node->addChild(comma_node);
-            eq_node->addChild(tau_node);
+                var_node->setNextSibling(nullptr);
+                expr_node->setNextSibling(nullptr);
 
-            // Iterate through the children and modify comma_node and tau_node
-            for (TreeNode *child : children)
-            {
-                comma_node->addChild(child->getChildren()[0]);
-                tau_node->addChild(child->getChildren()[1]);
+                if (last_var == nullptr)
+                {
+                    first_var = var_node;
+                    first_expr = expr_node;
+                }
+                else
+                {
+                    last_var->setNextSibling(var_node);
+                    last_expr->setNextSibling(expr_node);
+                }
+
+                last_var = var_node;
+                last_expr = expr_node;
+                eq_child = next;
             }
 
-            root_node = eq_node; // Assign the eq_node as the new root node
+            comma_node->setKind(NodeKind::COMMA);
+            comma_node->setChildren(first_var);
+            tau_node->setKind(NodeKind::TAU);
+            tau_node->setChildren(first_expr);
+            rewrite(currentNode, NodeKind::ASSIGN, {comma_node, tau_node});
+            return;
         }
-        else
+        case NodeKind::REC:
         {
-            throw std::runtime_error("Error: and node must have at least 2 children.");
-        }
-    } else if (currentNode->getLabel() == "rec")
-    {
-        if (currentNode->getNumChildren() == 1)
-        {
-            TreeNode *eq_node = currentNode->getChildren()[0];
-            TreeNode *var_node = eq_node->getChildren()[0];
-            TreeNode *expr_node = eq_node->getChildren()[1];
-
-            TreeNode *new_eq_node = new InternalNode("=");
-
-            new_eq_node->addChild(var_node);
+            if (currentNode->getNumChildren() != 1)
+            {
+                throw std::runtime_error("Error: rec node must have 1 child.");
+            }
 
-            TreeNode *new_gamma_node = new InternalNode("gamma");
-            TreeNode *new_lambda_node = new InternalNode("lambda");
-            TreeNode *y_str_node = new LeafNode("identifier", "Y*");
+            TreeNode *eq_node = currentNode->getChild(0);
+            TreeNode *var_node = eq_node->getChild(0);
+            TreeNode *expr_node = eq_node->getChild(1);
 
-            new_gamma_node->addChild(y_str_node);
-            new_gamma_node->addChild(new_lambda_node);
+            // rec X = E  =>  = X (gamma Y* (lambda X E)), with the "=" node becoming the gamma
+            // X appears twice, and a node has only one sibling link, so the lambda gets a copy
+            TreeNode *new_lambda_node = makeNode(tree, NodeKind::LAMBDA, {tree.cloneNode(var_node), expr_node});
+            rewrite(eq_node, NodeKind::GAMMA, {tree.newIdentifier(SYM_Y_STAR), new_lambda_node});
+            rewrite(currentNode, NodeKind::ASSIGN, {var_node, eq_node});
+            return;
+        }
+        default:
+            return;
+    }
+}
 
-            new_lambda_node->addChild(var_node);
-            new_lambda_node->addChild(expr_node);
+void generateST(TreeNode *currentNode, TreeNode *parentNode, Tree &tree)
+{
+    if (currentNode == nullptr)
+    {
+        return; // If the current node is nullptr, exit the function
+    }
 
-            new_eq_node->addChild(new_gamma_node);
+    // Walk the tree in post-order with an explicit stack, so a node is standardized after all of
+    // its children. Each pending entry is a node and the next child of it still to be visited.
+    // Nodes are rewritten in place, so no parent link ever has to be updated.
+    std::vector<std::pair<TreeNode *, TreeNode *>> pending;
+    pending.emplace_back(currentNode, currentNode->getFirstChild());
 
-            delete eq_node;
+    while (!pending.empty())
+    {
+        TreeNode *node = pending.back().first;
+        TreeNode *child = pending.back().second;
 
-            root_node = new_eq_node;
+        if (child != nullptr)
+        {
+            pending.back().second = child->getNextSibling();
+            pending.emplace_back(child, child->getFirstChild());
         }
         else
         {
-            throw std::runtime_error("Error: rec node must have 1 child.");
+            standardizeNode(node, tree);
+            pending.pop_back();
         }
     }
-    else
-    {
-        root_node = currentNode;
-    }
+
     if (parentNode == nullptr)
     {
-        // If the parentNode is null, set the root_node as the new syntax tree root
-        Tree::getInstance().setSTRoot(root_node);
-        return; // Exit the function
+        // If the parentNode is null, set the currentNode as the new syntax tree root
+        tree.setSTRoot(currentNode);
     }
     else
     {
-        // If the parentNode is not null, add the root_node as a child of the parentNode
-        parentNode->addChild(root_node);
-    }
-
-    if (root_node != currentNode)
-    {
-        // If the root_node and currentNode are different, it means the currentNode was replaced
-        delete currentNode; // Delete the old currentNode to free memory
+        // If the parentNode is not null, add the currentNode as a child of the parentNode
+        currentNode->setNextSibling(nullptr);
+        parentNode->addChild(currentNode);
     }
 }
-
-
-Tree *Tree::tree = new Tree(); // Initialize the singleton instance of the Tree
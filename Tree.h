@@ -6,49 +6,104 @@
 #define RPAL_FINAL_TREE_H
 
 
+#include <iostream>
+
+#include "Arena.h"
 #include "TreeNode.h"
 
 
+class Tree;
+
 /**
  * Generates the Syntax Tree (ST) by modifying the given tree structure.
  *
+ * The tree is walked in post-order with an explicit stack and rewritten in place, so this takes
+ * time linear in the number of nodes and works on trees of any depth.
+ *
  * @param currentNode The current node being processed.
  * @param parentNode The parent node of the current node.
+ * @param tree The tree whose ST root is set once the root node has been standardized.
+ */
+void generateST(TreeNode *currentNode, TreeNode *parentNode, Tree &tree);
+
+/**
+ * Applies the standardization rule for a node whose children are already standardized.
+ *
+ * Rewrites let, where, fcn_form, lambda, within, @, and and rec nodes in place into their gamma
+ * and lambda form, and leaves any other node unchanged. The node stays the root of its
+ * replacement and keeps its next sibling, so its parent needs no update; its "=" children are
+ * reused as well, and only the nodes a rule adds are allocated.
+ *
+ * @param currentNode The node to standardize.
+ * @param tree The tree that allocates the added nodes.
+ * @throws std::runtime_error if the node does not have the children its rule expects.
  */
-void generateST(TreeNode *currentNode, TreeNode *parentNode);
+void standardizeNode(TreeNode *currentNode, Tree &tree);
 
 
 /**
  * @brief Represents the Tree for a program.
  *
  * The Tree class stores the root nodes of the AST and ST and provides
- * access to them. It follows the Singleton design pattern to ensure
- * that only one instance of the Tree exists.
+ * access to them. Each compilation owns its own Tree (see CompilationContext).
+ *
+ * Every node of both trees is allocated in the Tree's arena, so building a node is a pointer
+ * bump and the whole tree is released at once when the Tree is destroyed.
  */
 class Tree
 {
 private:
-    static Tree *tree;           // The singleton instance of the Tree
-    TreeNode *astRoot = nullptr; // The root node of the Abstract Syntax Tree (AST)
-    TreeNode *stRoot = nullptr;  // The root node of the Standardized Tree (ST)
-
-    Tree() {} // Private constructor
-
-    ~Tree() = default; // Private destructor
+    Arena arena;                           // Owns every node of the AST and ST
+    TreeNode *astRoot = nullptr;           // The root node of the Abstract Syntax Tree (AST)
+    TreeNode *stRoot = nullptr;            // The root node of the Standardized Tree (ST)
+    size_t astBytes = 0;                   // Arena bytes used by parsing
+    size_t stBytes = 0;                    // Arena bytes added by standardizing
+    bool standardizedWhileParsing = false; // Whether the parser built the ST directly, without an AST
 
 public:
+    Tree() = default;
+
     Tree &operator=(const Tree &) = delete; // Disable assignment operator
 
     Tree(const Tree &) = delete; // Disable copy constructor
 
     /**
-     * @brief Returns the singleton instance of the Tree.
-     * @return The reference to the Tree instance.
+     * @brief Returns the arena the nodes of this tree are allocated in.
+     */
+    Arena &getArena();
+
+    /**
+     * @brief Allocates a node without a value in the tree's arena.
+     * @param kind The kind of the node.
+     * @return The new node.
+     */
+    TreeNode *newInternalNode(NodeKind kind);
+
+    /**
+     * @brief Allocates a leaf node in the tree's arena.
+     * @param kind The kind of the node.
+     * @param value The text of an integer or string node, copied into the arena; ignored for other kinds.
+     * @return The new node.
+     */
+    TreeNode *newLeafNode(NodeKind kind, std::string_view value);
+
+    /**
+     * @brief Allocates an identifier leaf node in the tree's arena.
+     * @param symbol The interned name of the identifier.
+     * @return The new node.
+     */
+    TreeNode *newIdentifier(symbol_id symbol);
+
+    /**
+     * @brief Allocates a copy of a node that shares its children but has no next sibling.
+     * @param node The node to copy.
+     * @return The copy.
      */
-    static Tree &getInstance();
+    TreeNode *cloneNode(const TreeNode *node);
 
     /**
      * @brief Sets the root node of the Abstract Syntax Tree (AST).
+     * The arena bytes used so far are recorded as the cost of parsing.
      * @param r The root node to set.
      */
     void setASTRoot(TreeNode *r);
@@ -65,6 +120,13 @@ public:
      */
     void setSTRoot(TreeNode *r);
 
+    /**
+     * @brief Sets the root node of a Standardized Tree (ST) the parser built directly.
+     * There is no AST, so generate() has nothing left to do.
+     * @param r The root node to set.
+     */
+    void setStandardizedRoot(TreeNode *r);
+
     /**
      * @brief Retrieves the root node of the Standardized Tree (ST).
      * @return The root node of the ST.
@@ -74,20 +136,18 @@ public:
     /**
      * @brief Releases the memory occupied by the Abstract Syntax Tree (AST).
      *
-     * This function calls the static releaseNodeMemory() function
-     * of the TreeNode class to release the memory of all AST nodes.
-     * It should be called when the AST is no longer needed to avoid memory leaks.
+     * The AST is standardized in place, so its nodes stay in the arena and
+     * become part of the ST.
      */
-    static void releaseASTMemory();
+    void releaseASTMemory();
 
     /**
      * @brief Releases the memory occupied by the Standardized Tree (ST).
      *
-     * This function calls the static releaseNodeMemory() function
-     * of the TreeNode class to release the memory of all ST nodes.
-     * It should be called when the ST is no longer needed to avoid memory leaks.
+     * This resets the arena, which frees every node of both trees at once.
+     * It should be called when the ST is no longer needed.
      */
-    [[maybe_unused]] static void releaseSTMemory();
+    [[maybe_unused]] void releaseSTMemory();
 
     /**
      * @brief Generates the Standardized Tree (ST) from the Abstract Syntax Tree (AST).
@@ -95,7 +155,13 @@ public:
      * This function calls the generateST() function to generate the ST from the AST.
      * It should be called when the AST is no longer needed to avoid memory leaks.
      */
-    static void generate();
+    void generate();
+
+    /**
+     * @brief Writes how many arena bytes parsing and standardizing used.
+     * @param out The stream to write to.
+     */
+    void writeMemoryReport(std::ostream &out) const;
 };
 
 #endif //RPAL_FINAL_TREE_H
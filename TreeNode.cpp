@@ -4,63 +4,150 @@
 
 #include "TreeNode.h"
 
-#include <utility>
+#include <cstring>
+#include <new>
+#include <type_traits>
 
-TreeNode::TreeNode(std::string l) : label(std::move(l)) {
-    children = std::vector<TreeNode *>();
-}
+static_assert(sizeof(TreeNode) <= 24, "TreeNode should stay within 24 bytes");
+static_assert(std::is_trivially_destructible_v<TreeNode>, "TreeNode lives in an Arena");
 
-void TreeNode::addChild(TreeNode *child) {
-    children.push_back(child);
+std::string_view nodeKindLabel(NodeKind kind) {
+    switch (kind)
+    {
+        case NodeKind::LET: return "let";
+        case NodeKind::LAMBDA: return "lambda";
+        case NodeKind::WHERE: return "where";
+        case NodeKind::TAU: return "tau";
+        case NodeKind::AUG: return "aug";
+        case NodeKind::CONDITIONAL: return "->";
+        case NodeKind::OR: return "or";
+        case NodeKind::AMP: return "&";
+        case NodeKind::NOT: return "not";
+        case NodeKind::GR: return "gr";
+        case NodeKind::GE: return "ge";
+        case NodeKind::LS: return "ls";
+        case NodeKind::LE: return "le";
+        case NodeKind::EQ: return "eq";
+        case NodeKind::NE: return "ne";
+        case NodeKind::PLUS: return "+";
+        case NodeKind::MINUS: return "-";
+        case NodeKind::NEG: return "neg";
+        case NodeKind::TIMES: return "*";
+        case NodeKind::DIVIDE: return "/";
+        case NodeKind::POWER: return "**";
+        case NodeKind::AT: return "@";
+        case NodeKind::GAMMA: return "gamma";
+        case NodeKind::IDENTIFIER: return "identifier";
+        case NodeKind::INTEGER: return "integer";
+        case NodeKind::STRING: return "string";
+        case NodeKind::TRUE: return "true";
+        case NodeKind::FALSE: return "false";
+        case NodeKind::NIL: return "nil";
+        case NodeKind::DUMMY: return "dummy";
+        case NodeKind::WITHIN: return "within";
+        case NodeKind::AND: return "and";
+        case NodeKind::REC: return "rec";
+        case NodeKind::ASSIGN: return "=";
+        case NodeKind::FCN_FORM: return "fcn_form";
+        case NodeKind::COMMA: return ",";
+        case NodeKind::EMPTY_PARENS: return "()";
+    }
+    return "";
 }
 
-void TreeNode::reverseChildren() {
-    std::reverse(children.begin(), children.end());
+bool isOperatorKind(NodeKind kind) {
+    switch (kind)
+    {
+        case NodeKind::PLUS:
+        case NodeKind::MINUS:
+        case NodeKind::DIVIDE:
+        case NodeKind::TIMES:
+        case NodeKind::AUG:
+        case NodeKind::NEG:
+        case NodeKind::NOT:
+        case NodeKind::EQ:
+        case NodeKind::GR:
+        case NodeKind::GE:
+        case NodeKind::LS:
+        case NodeKind::LE:
+        case NodeKind::NE:
+        case NodeKind::OR:
+        case NodeKind::AMP:
+            return true;
+        default:
+            return false;
+    }
 }
 
-void TreeNode::removeChild(int index, bool deleteNode) {
-    if (index < 0 || index >= children.size())
+void TreeNode::addChild(TreeNode *child) {
+    if (firstChild == nullptr)
     {
-        throw std::out_of_range("Index out of range");
+        firstChild = child;
+        return;
     }
 
-    if (deleteNode)
+    TreeNode *last = firstChild;
+    while (last->nextSibling != nullptr)
     {
-        releaseNodeMemory(children[index]);
+        last = last->nextSibling;
     }
-
-    children.erase(children.begin() + index);
+    last->nextSibling = child;
 }
 
-int TreeNode::getNumChildren() {
-    return static_cast<int>(children.size());
+void TreeNode::prependChild(TreeNode *child) {
+    child->nextSibling = firstChild;
+    firstChild = child;
 }
 
-std::string TreeNode::getLabel() {
-    return label;
+TreeNode *TreeNode::takeChildren() {
+    TreeNode *first = firstChild;
+    firstChild = nullptr;
+    return first;
 }
 
-std::vector<TreeNode *> &TreeNode::getChildren() {
-    return children;
+int TreeNode::getNumChildren() const {
+    int count = 0;
+    for (TreeNode *child = firstChild; child != nullptr; child = child->nextSibling)
+    {
+        count++;
+    }
+    return count;
 }
 
-std::string TreeNode::getValue() {
-    return value;
+std::string_view TreeNode::getLabel() const {
+    return nodeKindLabel(kind);
 }
 
-void TreeNode::setValue(std::string v) {
-    value = std::move(v);
+TreeNode *TreeNode::getChild(int index) const {
+    TreeNode *child = firstChild;
+    while (child != nullptr && index-- > 0)
+    {
+        child = child->nextSibling;
+    }
+    return child;
 }
 
-// NOLINTNEXTLINE
-void TreeNode::releaseNodeMemory(TreeNode *node) {
-    if (node == nullptr)
-        return;
+TreeNode *TreeNode::newLiteral(Arena &arena, NodeKind k, std::string_view text) {
+    // One allocation holds the node followed by its text, which getValue() finds at this + 1
+    void *memory = arena.allocate(sizeof(TreeNode) + text.size(), alignof(TreeNode));
+    auto *node = new(memory) TreeNode(k, static_cast<uint32_t>(text.size()));
+    std::memcpy(node + 1, text.data(), text.size());
+    return node;
+}
 
-    for (TreeNode *child : node->getChildren())
+std::string_view TreeNode::getValue() const {
+    switch (kind)
     {
-        releaseNodeMemory(child);
+        case NodeKind::IDENTIFIER:
+            return SymbolTable::getInstance().name(value);
+        case NodeKind::INTEGER:
+        case NodeKind::STRING:
+            return {reinterpret_cast<const char *>(this + 1), value};
+        default:
+            return {};
     }
+}
 
-    delete node;
+symbol_id TreeNode::getSymbol() const {
+    return kind == NodeKind::IDENTIFIER ? value : NO_SYMBOL;
 }
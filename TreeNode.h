@@ -5,136 +5,267 @@
 #ifndef RPAL_FINAL_TREENODE_H
 #define RPAL_FINAL_TREENODE_H
 
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <string>
-#include <utility>
-#include <vector>
-#include <algorithm>
-#include <stdexcept>
+#include <string_view>
+
+#include "Arena.h"
+#include "SymbolTable.h"
+
+/**
+ * @brief The kinds of AST and ST nodes.
+ */
+enum class NodeKind : uint8_t
+{
+    // Expressions
+    LET,
+    LAMBDA,
+    WHERE,
+    TAU,
+    AUG,
+    CONDITIONAL, // ->
+    OR,
+    AMP,         // &
+    NOT,
+    GR,
+    GE,
+    LS,
+    LE,
+    EQ,
+    NE,
+    PLUS,        // +
+    MINUS,       // -
+    NEG,
+    TIMES,       // *
+    DIVIDE,      // /
+    POWER,       // **
+    AT,          // @
+    GAMMA,
+
+    // Leaves
+    IDENTIFIER,
+    INTEGER,
+    STRING,
+    TRUE,
+    FALSE,
+    NIL,
+    DUMMY,
+
+    // Definitions
+    WITHIN,
+    AND,
+    REC,
+    ASSIGN,      // =
+    FCN_FORM,
+    COMMA,       // ,
+    EMPTY_PARENS // ()
+};
+
+/**
+ * @brief Returns the label a node kind is written as in the RPAL grammar and in visualizations.
+ * @param kind The node kind.
+ * @return The label, e.g. "gamma" or "->".
+ */
+std::string_view nodeKindLabel(NodeKind kind);
+
+/**
+ * @brief Checks whether a node kind is a unary or binary operator the CSE machine applies directly.
+ * @param kind The node kind.
+ * @return True for the arithmetic, comparison and boolean operators, aug and neg.
+ */
+bool isOperatorKind(NodeKind kind);
 
 /**
  * @brief Represents a node in a tree structure.
  *
- * The TreeNode class represents a node in a tree. It contains a label,
- * a vector of child nodes, and an optional value. It provides methods
- * to add children, reverse the order of children, and retrieve information
- * about the node.
+ * A node is a kind tag, a 32-bit value and two links: to its first child and to its next
+ * sibling, so a node takes 24 bytes and walking the tree never copies anything. Identifier
+ * leaves carry the symbol ID of their name. Integer and string leaves keep their text in the
+ * arena, right after the node, and the value is its length; literals are not interned, so a
+ * program's literals are freed with its tree instead of staying in the process-wide SymbolTable.
+ *
+ * Nodes are allocated in the Arena of their Tree and are never deleted one by one; the whole
+ * tree is released with the arena.
  */
 class TreeNode
 {
 private:
-    std::string label;                // The label of the node
-    std::vector<TreeNode *> children; // The child nodes of the current node
-    std::string value;                // The value associated with the node
+    TreeNode *firstChild = nullptr;  // The first child node, or nullptr for leaves
+    TreeNode *nextSibling = nullptr; // The next child of the parent node
+    symbol_id value = NO_SYMBOL;     // The symbol of an identifier, or the text length of a literal
+    NodeKind kind;                   // What the node stands for
 
 public:
     /**
-     * @brief Constructs a TreeNode object with the specified label.
-     * @param l The label of the node.
+     * @brief A forward range over the children of a node.
      */
-    explicit TreeNode(std::string  l);
+    class ChildRange
+    {
+    public:
+        class iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = TreeNode *;
+            using difference_type = std::ptrdiff_t;
+            using pointer = TreeNode **;
+            using reference = TreeNode *;
+
+            explicit iterator(TreeNode *node) : node(node) {}
+
+            TreeNode *operator*() const { return node; }
+
+            iterator &operator++()
+            {
+                node = node->nextSibling;
+                return *this;
+            }
+
+            bool operator==(const iterator &other) const { return node == other.node; }
+
+            bool operator!=(const iterator &other) const { return node != other.node; }
+
+        private:
+            TreeNode *node;
+        };
+
+        explicit ChildRange(TreeNode *first) : first(first) {}
+
+        [[nodiscard]] iterator begin() const { return iterator(first); }
+
+        [[nodiscard]] iterator end() const { return iterator(nullptr); }
+
+    private:
+        TreeNode *first;
+    };
+
+    /**
+     * @brief Constructs a TreeNode object of the specified kind.
+     * @param k The kind of the node.
+     * @param v The symbol ID of an identifier, or the text length of a literal.
+     */
+    explicit TreeNode(NodeKind k, symbol_id v = NO_SYMBOL) : value(v), kind(k) {}
 
     /**
-     * @brief Adds a child node to the current node.
-     * @param child The child node to add.
+     * @brief Allocates an integer or string leaf with its text in the given arena.
+     * @param arena The arena of the tree the leaf belongs to.
+     * @param k NodeKind::INTEGER or NodeKind::STRING.
+     * @param text The literal's text; it is copied.
+     * @return The new node.
+     */
+    static TreeNode *newLiteral(Arena &arena, NodeKind k, std::string_view text);
+
+    /**
+     * @brief Adds a child node after the current last child.
+     * @param child The child node to add. It must not be linked into another node.
      */
     void addChild(TreeNode *child);
 
     /**
-     * @brief Reverses the order of the child nodes.
+     * @brief Adds a child node before the current first child.
+     * @param child The child node to add. It must not be linked into another node.
      */
-    void reverseChildren();
+    void prependChild(TreeNode *child);
 
     /**
-     * @brief Removes a child node from the current node.
-     * @param index The index of the child node to remove.
-     * @param deleteNode Whether or not to delete the node.
+     * @brief Detaches every child node and returns the first one.
+     *
+     * The children stay linked to each other through their next sibling links.
+     * @return The first child, or nullptr if there were none.
      */
-    void removeChild(int index = 0, bool deleteNode = false);
+    TreeNode *takeChildren();
 
     /**
      * @brief Returns the number of child nodes.
      * @return The number of child nodes.
      */
-    int getNumChildren();
+    [[nodiscard]] int getNumChildren() const;
 
     /**
-     * @brief Returns the label of the node.
-     * @return The label of the node as a string.
+     * @brief Returns the kind of the node.
      */
-    std::string getLabel();
+    [[nodiscard]] NodeKind getKind() const
+    {
+        return kind;
+    }
 
     /**
-     * @brief Returns a reference to the vector of child nodes.
-     * @return A reference to the vector of child nodes.
+     * @brief Changes the kind of the node, for rewriting a tree in place.
+     * @param k The new kind. Nodes that have a value keep it.
      */
-    std::vector<TreeNode *> &getChildren();
+    void setKind(NodeKind k)
+    {
+        kind = k;
+    }
 
     /**
-     * @brief Returns the value associated with the node.
-     * @return The value of the node as a string.
+     * @brief Returns the label of the node.
+     * @return The label of the node's kind.
      */
-    virtual std::string getValue();
+    [[nodiscard]] std::string_view getLabel() const;
 
     /**
-     * @brief Sets the value associated with the node.
-     * @param v The value to set.
+     * @brief Returns the child at the given position.
+     * @param index The position of the child, counting from zero. Children are linked, so this walks index siblings.
+     * @return The child, or nullptr if there are not that many children.
      */
-    void setValue(std::string v);
+    [[nodiscard]] TreeNode *getChild(int index) const;
 
     /**
-     * @brief Releases the memory occupied by a TreeNode and its child nodes.
-     * @param node The node to release memory for.
+     * @brief Returns the first child node.
      */
-    static void releaseNodeMemory(TreeNode *node);
-};
+    [[nodiscard]] TreeNode *getFirstChild() const
+    {
+        return firstChild;
+    }
 
-/**
- * @brief Represents an internal node in a tree structure.
- *
- * The InternalNode class is a specialization of the TreeNode class
- * that represents an internal node in a tree. It has a label and an
- * optional value associated with it.
- */
-class InternalNode : public TreeNode
-{
-public:
     /**
-     * @brief Constructs an InternalNode object with the specified label and value.
-     * @param l The label of the internal node.
-     * @param v The value associated with the internal node (default: "").
+     * @brief Returns the next child of this node's parent.
      */
-    explicit InternalNode(const std::string &l, [[maybe_unused]] const std::string &v = " ") : TreeNode(l)
+    [[nodiscard]] TreeNode *getNextSibling() const
     {
-        setValue(" ");
+        return nextSibling;
+    }
+
+    /**
+     * @brief Replaces the children with nodes that are already linked through their next sibling links.
+     * @param first The first of the new children, or nullptr to remove every child.
+     */
+    void setChildren(TreeNode *first)
+    {
+        firstChild = first;
     }
-};
 
-/**
- * @brief Represents a leaf node in a tree structure.
- *
- * The LeafNode class is a specialization of the TreeNode class that
- * represents a leaf node in a tree. It has a label and a value associated
- * with it.
- */
-class LeafNode : public TreeNode
-{
-public:
     /**
-     * @brief Constructs a LeafNode object with the specified label and value.
-     * @param l The label of the leaf node.
-     * @param v The value associated with the leaf node.
+     * @brief Sets the next child of this node's parent.
+     * @param sibling The node that follows this one, or nullptr.
      */
-    LeafNode(const std::string &l, const std::string &v) : TreeNode(l)
+    void setNextSibling(TreeNode *sibling)
     {
-        setValue(v);
+        nextSibling = sibling;
     }
 
-#pragma clang diagnostic push
-#pragma ide diagnostic ignored "HidingNonVirtualFunction"
+    /**
+     * @brief Returns the child nodes, for use in a range-based for loop.
+     */
+    [[nodiscard]] ChildRange getChildren() const
+    {
+        return ChildRange(firstChild);
+    }
 
-    [[maybe_unused]] void addChild(TreeNode *child) = delete;
+    /**
+     * @brief Returns the text of identifier, integer and string nodes.
+     * @return The text, or an empty view for other nodes. A literal's text lives as long as its tree.
+     */
+    [[nodiscard]] std::string_view getValue() const;
 
-#pragma clang diagnostic pop
+    /**
+     * @brief Returns the interned name of an identifier node.
+     * @return The symbol ID, or NO_SYMBOL if the node is not an identifier.
+     */
+    [[nodiscard]] symbol_id getSymbol() const;
 };
 
 #endif //RPAL_FINAL_TREENODE_H
@@ -0,0 +1,159 @@
+#include "Tuple.h"
+
+
+Tuple::Tuple(std::vector<Value> elements) : count(static_cast<uint32_t>(elements.size()))
+{
+    // The tail keeps the last one to TUPLE_NODE_SIZE elements and the rest fill leaves, which are
+    // then grouped into branches level by level until one branch is left for the root
+    size_t trieCount = elements.empty() ? 0 : (elements.size() - 1) / TUPLE_NODE_SIZE * TUPLE_NODE_SIZE;
+
+    std::vector<TupleNode *> nodes;
+    nodes.reserve(trieCount / TUPLE_NODE_SIZE);
+    for (size_t start = 0; start < trieCount; start += TUPLE_NODE_SIZE)
+    {
+        auto *leaf = new TupleLeaf;
+        for (uint32_t i = 0; i < TUPLE_NODE_SIZE; i++)
+        {
+            leaf->elements[i] = std::move(elements[start + i]);
+        }
+        nodes.push_back(leaf);
+    }
+
+    if (!nodes.empty())
+    {
+        shift = 0;
+        do
+        {
+            std::vector<TupleNode *> parents;
+            parents.reserve((nodes.size() + TUPLE_NODE_SIZE - 1) / TUPLE_NODE_SIZE);
+            for (size_t start = 0; start < nodes.size(); start += TUPLE_NODE_SIZE)
+            {
+                auto *branch = new TupleBranch;
+                for (size_t i = start; i < nodes.size() && i < start + TUPLE_NODE_SIZE; i++)
+                {
+                    branch->children[i - start] = nodes[i];
+                }
+                parents.push_back(branch);
+            }
+            nodes = std::move(parents);
+            shift += TUPLE_NODE_BITS;
+        } while (nodes.size() > 1);
+
+        root = static_cast<TupleBranch *>(nodes[0]);
+    }
+
+    tail.reserve(elements.size() - trieCount);
+    for (size_t i = trieCount; i < elements.size(); i++)
+    {
+        tail.push_back(std::move(elements[i]));
+    }
+}
+
+Tuple *Tuple::append(const Tuple &tuple, Value element)
+{
+    auto *result = new Tuple();
+    result->count = tuple.count + 1;
+
+    if (tuple.tail.size() < TUPLE_NODE_SIZE)
+    {
+        result->shift = tuple.shift;
+        result->root = tuple.root;
+        if (result->root != nullptr)
+        {
+            result->root->references++;
+        }
+
+        result->tail.reserve(tuple.tail.size() + 1);
+        result->tail = tuple.tail;
+        result->tail.push_back(std::move(element));
+        return result;
+    }
+
+    // The full tail becomes a leaf at the end of the trie, and the new element starts a new tail
+    auto *leaf = new TupleLeaf;
+    for (uint32_t i = 0; i < TUPLE_NODE_SIZE; i++)
+    {
+        leaf->elements[i] = tuple.tail[i];
+    }
+    uint32_t trieCount = tuple.count - TUPLE_NODE_SIZE;
+
+    if (tuple.root == nullptr)
+    {
+        result->root = new TupleBranch;
+        result->root->children[0] = leaf;
+        result->shift = TUPLE_NODE_BITS;
+    }
+    else if ((trieCount >> TUPLE_NODE_BITS) == (1u << tuple.shift))
+    {
+        // The trie is full at its height, so it grows a level
+        result->root = new TupleBranch;
+        result->root->children[0] = tuple.root;
+        tuple.root->references++;
+        result->root->children[1] = newPath(tuple.shift, leaf);
+        result->shift = tuple.shift + TUPLE_NODE_BITS;
+    }
+    else
+    {
+        result->root = pushLeaf(tuple.root, tuple.shift, trieCount, leaf);
+        result->shift = tuple.shift;
+    }
+
+    result->tail.reserve(TUPLE_NODE_SIZE);
+    result->tail.push_back(std::move(element));
+    return result;
+}
+
+bool Tuple::appendInPlace(Value &element)
+{
+    if (tail.size() == TUPLE_NODE_SIZE)
+    {
+        return false;
+    }
+
+    tail.push_back(std::move(element));
+    count++;
+    return true;
+}
+
+TupleNode *Tuple::newPath(uint32_t level, TupleLeaf *leaf)
+{
+    if (level == 0)
+    {
+        return leaf;
+    }
+
+    auto *branch = new TupleBranch;
+    branch->children[0] = newPath(level - TUPLE_NODE_BITS, leaf);
+    return branch;
+}
+
+TupleBranch *Tuple::pushLeaf(const TupleBranch *parent, uint32_t level, uint32_t trieCount, TupleLeaf *leaf)
+{
+    // The copy shares every child but the one on the way to the new leaf, which is replaced
+    uint32_t slot = (trieCount >> level) & (TUPLE_NODE_SIZE - 1);
+
+    auto *copy = new TupleBranch;
+    for (uint32_t i = 0; i < TUPLE_NODE_SIZE; i++)
+    {
+        if (i != slot && parent->children[i] != nullptr)
+        {
+            copy->children[i] = parent->children[i];
+            copy->children[i]->references++;
+        }
+    }
+
+    const TupleNode *child = parent->children[slot];
+    if (level == TUPLE_NODE_BITS)
+    {
+        copy->children[slot] = leaf;
+    }
+    else if (child != nullptr)
+    {
+        copy->children[slot] = pushLeaf(static_cast<const TupleBranch *>(child), level - TUPLE_NODE_BITS, trieCount, leaf);
+    }
+    else
+    {
+        copy->children[slot] = newPath(level - TUPLE_NODE_BITS, leaf);
+    }
+    return copy;
+}
@@ -0,0 +1,168 @@
+#ifndef RPAL_FINAL_TUPLE_H
+#define RPAL_FINAL_TUPLE_H
+
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "Value.h"
+
+
+constexpr uint32_t TUPLE_NODE_BITS = 5;                    // Bits of an index each trie level consumes
+constexpr uint32_t TUPLE_NODE_SIZE = 1u << TUPLE_NODE_BITS; // Children of a branch, elements of a leaf
+
+/**
+ * @brief A node of a tuple's trie, shared by every tuple that was built from the one that made it.
+ */
+struct TupleNode : Counted
+{
+};
+
+/**
+ * @brief TUPLE_NODE_SIZE consecutive elements of a tuple. Leaves are always full.
+ */
+struct TupleLeaf : TupleNode
+{
+    std::array<Value, TUPLE_NODE_SIZE> elements;
+};
+
+/**
+ * @brief A level of a tuple's trie: leaves if it is at level TUPLE_NODE_BITS, branches above that.
+ */
+struct TupleBranch : TupleNode
+{
+    std::array<TupleNode *, TUPLE_NODE_SIZE> children{}; // nullptr after the last child
+};
+
+/**
+ * @brief An immutable tuple, shared by every Value that refers to it.
+ *
+ * The elements are kept as a persistent vector. All but the last few sit in full leaves under a
+ * trie of TUPLE_NODE_SIZE-way branches, and the last one to TUPLE_NODE_SIZE sit in a tail the
+ * tuple owns. Appending an element copies the tail, and once every TUPLE_NODE_SIZE elements the
+ * path from the root to the new leaf, and shares everything else with the original tuple, so aug
+ * takes amortized constant time and a tuple another value can see never changes. Indexing goes
+ * down one branch per level, and there are at most seven levels.
+ *
+ * A node only refers to elements and nodes that already existed when it was made, so tuples
+ * cannot form cycles and reference counting frees them all.
+ */
+class Tuple : public Counted
+{
+public:
+    /**
+     * @param elements The elements, in order; the tuple takes them over.
+     */
+    explicit Tuple(std::vector<Value> elements);
+
+    Tuple(const Tuple &) = delete;
+
+    Tuple &operator=(const Tuple &) = delete;
+
+    /**
+     * @brief Makes a tuple of the elements of another followed by one more, sharing the other's
+     * storage.
+     */
+    static Tuple *append(const Tuple &tuple, Value element);
+
+    /**
+     * @brief Appends an element to this tuple itself, if it fits in the tail.
+     *
+     * Only allowed while nothing but the caller refers to the tuple.
+     *
+     * @return Whether the element was appended; if not, it is left as it was.
+     */
+    bool appendInPlace(Value &element);
+
+    [[nodiscard]] uint32_t size() const
+    {
+        return count;
+    }
+
+    /**
+     * @brief Returns the element at a 0-based index, which must be below size().
+     */
+    [[nodiscard]] const Value &operator[](uint32_t index) const
+    {
+        uint32_t trieCount = count - static_cast<uint32_t>(tail.size());
+        if (index >= trieCount)
+        {
+            return tail[index - trieCount];
+        }
+
+        const TupleNode *node = root;
+        for (uint32_t level = shift; level > 0; level -= TUPLE_NODE_BITS)
+        {
+            node = static_cast<const TupleBranch *>(node)->children[(index >> level) & (TUPLE_NODE_SIZE - 1)];
+        }
+        return static_cast<const TupleLeaf *>(node)->elements[index & (TUPLE_NODE_SIZE - 1)];
+    }
+
+    /**
+     * @brief Lets go of everything the tuple holds, before it is deleted.
+     *
+     * Nodes no other tuple shares are freed here; the trie is shallow, so this recursion is
+     * bounded. Each element of the tail and of a freed leaf is handed to drop, which must
+     * release it and leave it empty, so nested tuples are freed by the caller's loop instead.
+     */
+    template<typename Drop>
+    void dismantle(Drop &drop)
+    {
+        for (Value &element : tail)
+        {
+            drop(element);
+        }
+        if (root != nullptr)
+        {
+            release(root, shift, drop);
+            root = nullptr;
+        }
+    }
+
+private:
+    Tuple() = default;
+
+    static TupleNode *newPath(uint32_t level, TupleLeaf *leaf);
+
+    static TupleBranch *pushLeaf(const TupleBranch *parent, uint32_t level, uint32_t trieCount, TupleLeaf *leaf);
+
+    template<typename Drop>
+    static void release(TupleNode *node, uint32_t level, Drop &drop)
+    {
+        if (--node->references != 0)
+        {
+            return;
+        }
+
+        if (level == 0)
+        {
+            auto *leaf = static_cast<TupleLeaf *>(node);
+            for (Value &element : leaf->elements)
+            {
+                drop(element);
+            }
+            delete leaf;
+        }
+        else
+        {
+            auto *branch = static_cast<TupleBranch *>(node);
+            for (TupleNode *child : branch->children)
+            {
+                if (child != nullptr)
+                {
+                    release(child, level - TUPLE_NODE_BITS, drop);
+                }
+            }
+            delete branch;
+        }
+    }
+
+    uint32_t count = 0;               // Number of elements
+    uint32_t shift = TUPLE_NODE_BITS; // Level of the root: how far an index is shifted to pick its child
+    TupleBranch *root = nullptr;      // The trie of full leaves, or nullptr if the tail holds everything
+    std::vector<Value> tail;          // The last elements; empty only in the empty tuple
+};
+
+
+#endif //RPAL_FINAL_TUPLE_H
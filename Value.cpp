@@ -0,0 +1,199 @@
+#include "Value.h"
+#include "Text.h"
+#include "Tuple.h"
+
+#include <tuple>
+
+
+Value Value::tuple(std::vector<Value> elements)
+{
+    Value result;
+    result.tag = ValueKind::TUPLE;
+    result.payload.tuple = new Tuple(std::move(elements));
+    return result;
+}
+
+Value Value::string(std::string characters)
+{
+    Value result;
+    result.tag = ValueKind::STRING;
+    result.payload.text = new Text(std::move(characters));
+    return result;
+}
+
+Value Value::concatenation(Value left, Value right)
+{
+    uint32_t leftLength = left.payload.text->size() - left.extra;
+    uint32_t rightLength = right.payload.text->size() - right.extra;
+
+    if (rightLength == 0)
+    {
+        return left;
+    }
+    if (leftLength == 0)
+    {
+        return right;
+    }
+    if (leftLength + rightLength <= Text::FLAT_LIMIT)
+    {
+        std::string characters(left.asString());
+        characters += right.asString();
+        return string(std::move(characters));
+    }
+
+    Value result;
+    result.tag = ValueKind::STRING;
+    result.payload.text = new Text(std::move(left), std::move(right));
+    return result;
+}
+
+Value Value::suffix(const Value &string, uint32_t count)
+{
+    // Only flat texts are sliced, so the characters of a concatenation are written out first
+    static_cast<void>(string.payload.text->characters());
+
+    Value result = string;
+    result.extra += count;
+    return result;
+}
+
+std::string_view Value::asString() const
+{
+    return payload.text->characters().substr(extra);
+}
+
+Value Value::integer(BigInt value)
+{
+    if (value.fitsInt64())
+    {
+        return integer(value.toInt64());
+    }
+
+    Value result;
+    result.tag = ValueKind::BIG_INTEGER;
+    result.payload.bigInteger = new BigInteger(std::move(value));
+    return result;
+}
+
+Value Value::newEnv(Env *parent, uint32_t lambda, uint32_t number, uint32_t slotCount)
+{
+    Value result;
+    result.tag = ValueKind::ENV;
+    result.payload.env = Env::create(parent, lambda, number, slotCount);
+    return result;
+}
+
+Env *Env::create(Env *parent, uint32_t lambda, uint32_t number, uint32_t slotCount)
+{
+    if (parent != nullptr)
+    {
+        parent->references++;
+    }
+    void *memory = ::operator new(sizeof(Env) + slotCount * sizeof(Value));
+    return new(memory) Env(parent, lambda, number);
+}
+
+Value Value::append(Value tuple, Value element)
+{
+    if (tuple.payload.tuple->references == 1 && tuple.payload.tuple->appendInPlace(element))
+    {
+        return tuple;
+    }
+
+    Value result;
+    result.tag = ValueKind::TUPLE;
+    result.payload.tuple = Tuple::append(*tuple.payload.tuple, std::move(element));
+    return result;
+}
+
+BigInt Value::asBigInt() const
+{
+    return tag == ValueKind::BIG_INTEGER ? payload.bigInteger->value : BigInt(payload.integer);
+}
+
+void Value::destroy(ValueKind kind, Counted *object)
+{
+    // Tuples, strings and environments whose last reference went while freeing another. They
+    // are freed by this loop instead of by the destructors of the Values holding them, so
+    // nesting depth does not matter. The first one waits in kind and object, and the list is
+    // only allocated when a second turns up before it is taken
+    std::vector<std::pair<ValueKind, Counted *>> dead;
+    bool taken = true;
+
+    auto release = [&](ValueKind childKind, Counted *child) {
+        if (--child->references != 0)
+        {
+            return;
+        }
+        if (childKind == ValueKind::BIG_INTEGER)
+        {
+            delete static_cast<BigInteger *>(child);
+        }
+        else if (taken)
+        {
+            kind = childKind;
+            object = child;
+            taken = false;
+        }
+        else
+        {
+            dead.emplace_back(childKind, child);
+        }
+    };
+
+    auto drop = [&](Value &value) {
+        if (value.counted())
+        {
+            release(value.tag, value.payload.counted);
+        }
+        value.tag = ValueKind::INTEGER;
+    };
+
+    while (true)
+    {
+        Counted *next = object;
+        ValueKind nextKind = kind;
+        taken = true;
+
+        if (nextKind == ValueKind::TUPLE)
+        {
+            auto *tuple = static_cast<Tuple *>(next);
+            tuple->dismantle(drop);
+            delete tuple;
+        }
+        else if (nextKind == ValueKind::BIG_INTEGER)
+        {
+            delete static_cast<BigInteger *>(next);
+        }
+        else if (nextKind == ValueKind::STRING)
+        {
+            auto *text = static_cast<Text *>(next);
+            text->dismantle(drop);
+            delete text;
+        }
+        else
+        {
+            auto *env = static_cast<Env *>(next);
+            for (uint32_t slot = 0; slot < env->filled; slot++)
+            {
+                drop(env->slots()[slot]);
+            }
+            if (env->parent != nullptr)
+            {
+                release(ValueKind::ENV, env->parent);
+            }
+            env->~Env();
+            ::operator delete(env);
+        }
+
+        if (taken)
+        {
+            if (dead.empty())
+            {
+                return;
+            }
+            std::tie(kind, object) = dead.back();
+            dead.pop_back();
+        }
+    }
+}
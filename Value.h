@@ -0,0 +1,434 @@
+#ifndef RPAL_FINAL_VALUE_H
+#define RPAL_FINAL_VALUE_H
+
+
+#include <cstdint>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "BigInt.h"
+#include "SymbolTable.h"
+
+
+/**
+ * @brief What a Value holds.
+ */
+enum class ValueKind : uint8_t
+{
+    INTEGER,     // An integer that fits in 64 bits
+    BOOLEAN,     // true or false
+    BUILTIN,     // A built-in function, named by its symbol ID
+    TUPLE,       // A reference to a Tuple
+    BIG_INTEGER, // A reference to a BigInteger, for integers that do not fit in 64 bits
+    STRING,      // A reference to a Text and the offset the string starts at in it
+    CLOSURE,     // A lambda and a reference to the Env it was created in
+    EETA,        // The fixed point Y* made of a closure
+    ENV          // The marker a lambda application leaves on the stack, referring to its Env
+};
+
+struct Counted;
+class Tuple;
+class Text;
+struct BigInteger;
+class Env;
+
+/**
+ * @brief A value of the CSE machine: what its stack holds and what environments bind.
+ *
+ * A Value is 16 bytes: a kind and an inline payload. Integers, booleans and built-ins never
+ * touch the heap, so arithmetic and comparisons work on registers. Tuples, big integers,
+ * strings and environments are reference counted and immutable once made, so copying a Value
+ * that holds one only shares it, and each is freed with its last reference.
+ *
+ * Integers are unbounded: one that fits in 64 bits is always an inline INTEGER, and only one
+ * that does not is a BIG_INTEGER, so two integers of different kinds are never equal.
+ */
+class Value
+{
+public:
+    Value() = default;
+
+    Value(const Value &other) : tag(other.tag), extra(other.extra), payload(other.payload)
+    {
+        retain();
+    }
+
+    Value(Value &&other) noexcept : tag(other.tag), extra(other.extra), payload(other.payload)
+    {
+        other.tag = ValueKind::INTEGER;
+    }
+
+    Value &operator=(const Value &other)
+    {
+        if (this != &other)
+        {
+            other.retain();
+            release();
+            tag = other.tag;
+            extra = other.extra;
+            payload = other.payload;
+        }
+        return *this;
+    }
+
+    Value &operator=(Value &&other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            tag = other.tag;
+            extra = other.extra;
+            payload = other.payload;
+            other.tag = ValueKind::INTEGER;
+        }
+        return *this;
+    }
+
+    ~Value()
+    {
+        release();
+    }
+
+    static Value integer(int64_t value)
+    {
+        Value result;
+        result.payload.integer = value;
+        return result;
+    }
+
+    /**
+     * @brief Makes an inline INTEGER if the value fits in 64 bits, or a BIG_INTEGER otherwise.
+     */
+    static Value integer(BigInt value);
+
+    static Value boolean(bool value)
+    {
+        Value result;
+        result.tag = ValueKind::BOOLEAN;
+        result.payload.boolean = value;
+        return result;
+    }
+
+    /**
+     * @brief Makes a string of the given characters.
+     */
+    static Value string(std::string characters);
+
+    /**
+     * @brief Makes the string of one string's characters followed by another's, as Conc does.
+     *
+     * Short results are copied; longer ones are a concatenation that is only flattened when its
+     * characters are read, so building a string by repeated Conc takes linear time.
+     */
+    static Value concatenation(Value left, Value right);
+
+    /**
+     * @brief Returns a string without its first count characters, as Stern does, sharing its
+     * text.
+     * @param count At most the string's length.
+     */
+    static Value suffix(const Value &string, uint32_t count);
+
+    /**
+     * @param elements The elements, in order; the new tuple takes them over.
+     */
+    static Value tuple(std::vector<Value> elements);
+
+    /**
+     * @brief Makes a tuple of the elements of another followed by one more, as aug does.
+     *
+     * The new tuple shares the old one's storage; if the old one has no other reference, the
+     * element may simply be added to it.
+     */
+    static Value append(Value tuple, Value element);
+
+    /**
+     * @param lambda The index of the lambda in the Program.
+     * @param env The environment the lambda was created in; the closure shares it.
+     */
+    static inline Value closure(uint32_t lambda, Env *env);
+
+    /**
+     * @param lambda The index of the lambda Y* was applied to.
+     * @param env The environment that lambda was created in; the eeta shares it.
+     */
+    static Value eeta(uint32_t lambda, Env *env)
+    {
+        Value result = closure(lambda, env);
+        result.tag = ValueKind::EETA;
+        return result;
+    }
+
+    static Value builtin(symbol_id function)
+    {
+        Value result;
+        result.tag = ValueKind::BUILTIN;
+        result.payload.builtin = function;
+        return result;
+    }
+
+    /**
+     * @brief Makes an environment with no slots filled.
+     * @param parent The environment the applied lambda was created in, or nullptr for the
+     * global environment; the new one shares it.
+     * @param lambda The applied lambda; UINT32_MAX for the global environment.
+     * @param number The number ENV markers of the environment show as text.
+     * @param slotCount The number of variables the lambda binds.
+     * @return The ENV marker of the new environment, which holds its only reference.
+     */
+    static Value newEnv(Env *parent, uint32_t lambda, uint32_t number, uint32_t slotCount);
+
+    [[nodiscard]] ValueKind kind() const
+    {
+        return tag;
+    }
+
+    /**
+     * @brief Checks whether the value is an integer of either kind.
+     */
+    [[nodiscard]] bool isInteger() const
+    {
+        return tag == ValueKind::INTEGER || tag == ValueKind::BIG_INTEGER;
+    }
+
+    [[nodiscard]] int64_t asInteger() const
+    {
+        return payload.integer;
+    }
+
+    /**
+     * @brief Returns an integer of either kind as a BigInt.
+     */
+    [[nodiscard]] BigInt asBigInt() const;
+
+    [[nodiscard]] bool asBoolean() const
+    {
+        return payload.boolean;
+    }
+
+    /**
+     * @brief Returns the characters of a string, flattening its text first if Conc left it as
+     * a concatenation.
+     */
+    [[nodiscard]] std::string_view asString() const;
+
+    [[nodiscard]] Text &asText() const
+    {
+        return *payload.text;
+    }
+
+    /**
+     * @brief Returns the offset in its text that a string starts at.
+     */
+    [[nodiscard]] uint32_t stringStart() const
+    {
+        return extra;
+    }
+
+    [[nodiscard]] const Tuple &asTuple() const
+    {
+        return *payload.tuple;
+    }
+
+    [[nodiscard]] symbol_id asBuiltin() const
+    {
+        return payload.builtin;
+    }
+
+    /**
+     * @brief Returns the lambda of a closure or eeta.
+     */
+    [[nodiscard]] uint32_t lambda() const
+    {
+        return extra;
+    }
+
+    /**
+     * @brief Returns the environment of a closure or eeta, or the one an ENV marker stands for.
+     */
+    [[nodiscard]] Env *env() const
+    {
+        return payload.env;
+    }
+
+private:
+    inline void retain() const;
+
+    inline void release();
+
+    [[nodiscard]] bool counted() const
+    {
+        return tag >= ValueKind::TUPLE;
+    }
+
+    /**
+     * @brief Frees an object whose last reference is gone. A tuple or environment takes along
+     * any objects that only it referenced, without recursion, so deep nesting and long chains
+     * of environments are fine.
+     */
+    static void destroy(ValueKind kind, Counted *object);
+
+private:
+    ValueKind tag = ValueKind::INTEGER;
+    uint32_t extra = 0; // In what would be padding: a closure's lambda, or where a string starts
+
+
+    union Payload
+    {
+        int64_t integer;
+        bool boolean;
+        Text *text;
+        Counted *counted;
+        Tuple *tuple;
+        BigInteger *bigInteger;
+        Env *env;
+        symbol_id builtin;
+    } payload{0};
+};
+
+static_assert(sizeof(Value) == 16);
+
+/**
+ * @brief The reference count at the start of every heap object a Value can refer to.
+ */
+struct Counted
+{
+    uint32_t references = 1; // Number of Values that refer to the object
+};
+
+/**
+ * @brief An immutable integer too large for 64 bits, shared by every Value that refers to it.
+ */
+struct BigInteger : Counted
+{
+    BigInt value;
+
+    explicit BigInteger(BigInt value) : value(std::move(value))
+    {}
+};
+
+/**
+ * @brief The variables one lambda application binds, or the built-in functions and nil for
+ * the global environment.
+ *
+ * Each variable has a slot, in the order the lambda lists them. The compiler resolves every
+ * identifier it can to a depth and a slot, so looking one up follows that many parent links
+ * and indexes the slots, without comparing names.
+ *
+ * An environment is shared by its ENV marker, the closures made in it and its child
+ * environments. Its slots are filled when it is made, from values that already existed, and
+ * never change afterwards, so no environment can ever come to refer back to itself: reference
+ * counting frees every one that becomes unreachable, without a cycle collector.
+ */
+class Env : public Counted
+{
+public:
+    /**
+     * @brief Allocates an environment with no slots filled, with room for slotCount slots
+     * right after it, so an environment and its variables take one allocation.
+     * @param parent The environment the applied lambda was created in, or nullptr; the new
+     * one shares it.
+     */
+    static Env *create(Env *parent, uint32_t lambda, uint32_t number, uint32_t slotCount);
+
+    Env(const Env &) = delete;
+
+    Env &operator=(const Env &) = delete;
+
+    /**
+     * @brief Fills the next slot; there must be one left. A tuple argument with fewer elements
+     * than the lambda has variables fills fewer slots.
+     */
+    void bind(Value value)
+    {
+        new(&slots()[filled++]) Value(std::move(value));
+    }
+
+    /**
+     * @brief Returns the environment depth levels out, this one being depth 0.
+     */
+    [[nodiscard]] Env *enclosing(uint32_t depth)
+    {
+        Env *env = this;
+        for (; depth > 0; depth--)
+        {
+            env = env->parent;
+        }
+        return env;
+    }
+
+    /**
+     * @brief Returns the value in a slot of the environment depth levels out, or nullptr if
+     * the slot was never filled.
+     */
+    [[nodiscard]] const Value *lookup(uint32_t depth, uint32_t slot)
+    {
+        Env *env = enclosing(depth);
+        return slot < env->filled ? &env->slots()[slot] : nullptr;
+    }
+
+    /**
+     * @brief Returns the lambda whose application made the environment.
+     */
+    [[nodiscard]] uint32_t lambda() const
+    {
+        return appliedLambda;
+    }
+
+    [[nodiscard]] uint32_t number() const
+    {
+        return sequenceNumber;
+    }
+
+private:
+    friend class Value; // Value::destroy takes the parent and slots apart without recursion
+
+    Env(Env *parent, uint32_t lambda, uint32_t number) :
+            parent(parent), appliedLambda(lambda), sequenceNumber(number)
+    {}
+
+    Value *slots()
+    {
+        return reinterpret_cast<Value *>(this + 1);
+    }
+
+    Env *parent;             // Shared with the environment's other children; nullptr for the global one
+    uint32_t appliedLambda;  // UINT32_MAX for the global environment
+    uint32_t sequenceNumber; // Order of creation in the machine, the global environment being 0
+    uint32_t filled = 0;     // Number of slots bound so far
+};
+
+static_assert(sizeof(Env) % alignof(Value) == 0);
+
+inline Value Value::closure(uint32_t lambda, Env *env)
+{
+    env->references++;
+
+    Value result;
+    result.tag = ValueKind::CLOSURE;
+    result.extra = lambda;
+    result.payload.env = env;
+    return result;
+}
+
+inline void Value::retain() const
+{
+    if (counted())
+    {
+        payload.counted->references++;
+    }
+}
+
+inline void Value::release()
+{
+    if (counted() && --payload.counted->references == 0)
+    {
+        destroy(tag, payload.counted);
+    }
+}
+
+
+#endif //RPAL_FINAL_VALUE_H
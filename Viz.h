@@ -90,10 +90,10 @@ int generateDotFileHelper(TreeNode *node, std::ofstream &file, int parent = -1,
     // Determine colors and fill based on node values
     std::string labelColor = "darkblue";
     std::string valueColor = "darkgreen";
-    std::string fillColor = (node->getValue() == " " || node->getValue().empty()) ? "#CCCCCC" : "#FFFFFF";
+    std::string fillColor = node->getValue().empty() ? "#CCCCCC" : "#FFFFFF";
 
     // Escape label characters if necessary
-    std::string escapedLabel = node->getLabel();
+    std::string escapedLabel(node->getLabel());
 
     size_t pos1 = escapedLabel.find('&');
     while (pos1 != std::string::npos)
@@ -111,7 +111,7 @@ int generateDotFileHelper(TreeNode *node, std::ofstream &file, int parent = -1,
 
     // Prepare label and value strings for the dot file
     std::string labelStr = (escapedLabel.empty()) ? "&nbsp;" : escapedLabel;
-    std::string valueStr = (node->getValue().empty()) ? "&nbsp;" : node->getValue();
+    std::string valueStr = (node->getValue().empty()) ? "&nbsp;" : std::string(node->getValue());
 
     size_t pos2 = valueStr.find('\n');
 
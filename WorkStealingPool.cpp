@@ -0,0 +1,82 @@
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <thread>
+
+WorkStealingPool::WorkStealingPool(unsigned threads) : threads(threads) {
+    if (this->threads == 0)
+    {
+        this->threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+unsigned WorkStealingPool::size() const {
+    return threads;
+}
+
+void WorkStealingPool::run(size_t count, const std::function<void(size_t)> &task) {
+    size_t workers = std::min<size_t>(threads, std::max<size_t>(count, 1));
+    queues = std::vector<WorkQueue>(workers);
+
+    // Give each worker a contiguous share so neighbouring tasks start on the same thread
+    for (size_t w = 0; w < workers; w++)
+    {
+        size_t begin = count * w / workers;
+        size_t end = count * (w + 1) / workers;
+        for (size_t i = begin; i < end; i++)
+        {
+            queues[w].tasks.push_back(i);
+        }
+    }
+
+    auto work = [this, &task](size_t worker) {
+        size_t index;
+        while (next(worker, index))
+        {
+            task(index);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (size_t w = 1; w < workers; w++)
+    {
+        pool.emplace_back(work, w);
+    }
+
+    // The calling thread is worker 0
+    work(0);
+
+    for (std::thread &thread : pool)
+    {
+        thread.join();
+    }
+    queues.clear();
+}
+
+bool WorkStealingPool::next(size_t worker, size_t &task) {
+    {
+        WorkQueue &own = queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty())
+        {
+            task = own.tasks.front();
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+
+    // Tasks never spawn other tasks, so once every queue has been seen empty there is no more work
+    for (size_t offset = 1; offset < queues.size(); offset++)
+    {
+        WorkQueue &victim = queues[(worker + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,67 @@
+#ifndef RPAL_FINAL_WORKSTEALINGPOOL_H
+#define RPAL_FINAL_WORKSTEALINGPOOL_H
+
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+
+/**
+ * @brief Runs a batch of independent tasks on a fixed number of threads.
+ *
+ * Every worker starts with its own contiguous share of the task indices in a private deque.
+ * It takes work from the front of that deque, and once it runs dry it steals from the back of
+ * another worker's deque. Short and long tasks therefore balance out without a shared queue
+ * that every thread contends on.
+ */
+class WorkStealingPool
+{
+public:
+    /**
+     * @brief Creates a pool.
+     * @param threads The number of worker threads. Zero means one per hardware thread.
+     */
+    explicit WorkStealingPool(unsigned threads);
+
+    /**
+     * @brief Runs task(i) for every i in [0, count) and waits for all of them to finish.
+     *
+     * Tasks must not throw; the caller is expected to catch and record its own errors.
+     * @param count The number of tasks.
+     * @param task The task to run, called with the task index.
+     */
+    void run(size_t count, const std::function<void(size_t)> &task);
+
+    /**
+     * @brief Returns the number of worker threads.
+     */
+    [[nodiscard]] unsigned size() const;
+
+private:
+    /**
+     * @brief A worker's queue of task indices.
+     */
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    /**
+     * @brief Takes the next task of the given worker, stealing from the others if its own queue is empty.
+     * @param worker The index of the worker asking for work.
+     * @param task Set to the task index when one is found.
+     * @return False once every queue is empty.
+     */
+    bool next(size_t worker, size_t &task);
+
+private:
+    unsigned threads;
+    std::vector<WorkQueue> queues;
+};
+
+
+#endif //RPAL_FINAL_WORKSTEALINGPOOL_H
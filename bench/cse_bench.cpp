@@ -0,0 +1,205 @@
+// CSE machine benchmark.
+//
+// Measures evaluation alone (parsing and compiling are not timed) on generated programs that
+// mostly do integer arithmetic and comparisons, the work the machine's value representation
+// decides the cost of, and on building and reading a long tuple and a long string.
+//
+//     cse_bench [-width=N] [-depth=N] [-factorial=N] [-fibonacci=N] [-squarings=N] [-bigprint=N]
+//               [-augs=N] [-concs=N] [-iterations=N]
+//
+// Wide inputs are one expression of N (default 200000) terms over a few variables; deep inputs
+// recurse N (default 20000) times, doing some arithmetic at every level, and the tail loop
+// counts down from 10 N in tail calls, which run in constant space. Those stay within 64
+// bits. The rest grow integers well past it: N! (default 3000), the Nth Fibonacci number
+// (default 20000) and 3 squared N times (default 16), each printed in full. Big print squares
+// 3 N times too (default 18, about 125000 digits), which is quick next to printing the result,
+// so it mostly measures the conversion to decimal. The tuple input grows a tuple by N (default
+// 20000) augs, then sums it by indexing every element; the string input grows a string by N
+// (default 20000) Concs, then counts it with Stern.
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../CompilationContext.h"
+#include "../CSE.h"
+#include "../Lexer.h"
+#include "../Parser.h"
+
+static std::string wideArithmetic(size_t width)
+{
+    std::string source = "let x = 7 in let y = 5 in Print (0";
+    for (size_t i = 0; i < width; i += 4)
+        source += " + x * y - x / 3";
+    return source + ")";
+}
+
+static std::string wideComparisons(size_t width)
+{
+    std::string source = "let x = 7 in let y = 5 in Print (x ls y";
+    for (size_t i = 0; i < width; i += 4)
+        source += " or x - y ge 2 & not x eq y";
+    return source + ")";
+}
+
+static std::string wideConditionals(size_t width)
+{
+    std::string source = "let x = 7 in let y = 5 in Print (0";
+    for (size_t i = 0; i < width; i += 4)
+        source += " + (x gr y -> x - y | y * 2)";
+    return source + ")";
+}
+
+static std::string deepSum(size_t depth)
+{
+    return "let rec sum n = n eq 0 -> 0 | n * 3 - 2 * n + sum (n - 1) in Print (sum " + std::to_string(depth) + ")";
+}
+
+static std::string tailLoop(size_t n)
+{
+    return "let rec loop n total = n eq 0 -> total | loop (n - 1) (total + n) in Print (loop " +
+           std::to_string(n) + " 0)";
+}
+
+static std::string factorial(size_t n)
+{
+    return "let rec fact n = n eq 0 -> 1 | n * fact (n - 1) in Print (fact " + std::to_string(n) + ")";
+}
+
+static std::string fibonacci(size_t n)
+{
+    return "let rec fib n a b = n eq 0 -> a | fib (n - 1) b (a + b) in Print (fib " + std::to_string(n) + " 0 1)";
+}
+
+static std::string squarings(size_t n)
+{
+    return "let rec square x n = n eq 0 -> x | square (x * x) (n - 1) in Print (square 3 " + std::to_string(n) + ")";
+}
+
+static std::string bigPrint(size_t n)
+{
+    return "let rec square x n = n eq 0 -> x | square (x * x) (n - 1) in Print (square 3 " + std::to_string(n) + ")";
+}
+
+static std::string augLoop(size_t n)
+{
+    return "let rec build n t = n eq 0 -> t | build (n - 1) (t aug n) in "
+           "let t = build " + std::to_string(n) + " nil in "
+           "let rec sum i = i eq 0 -> 0 | t i + sum (i - 1) in Print (sum (Order t))";
+}
+
+static std::string concLoop(size_t n)
+{
+    return "let rec build n s = n eq 0 -> s | build (n - 1) (Conc s 'ab') in "
+           "let rec length s = s eq '' -> 0 | 1 + length (Stern s) in "
+           "Print (length (build " + std::to_string(n) + " ''))";
+}
+
+int main(int argc, char *argv[])
+{
+    size_t width = 200000;
+    size_t depth = 20000;
+    size_t factorialOf = 3000;
+    size_t fibonacciOf = 20000;
+    size_t squaringCount = 16;
+    size_t bigPrintSquarings = 18;
+    size_t augCount = 20000;
+    size_t concCount = 20000;
+    int iterations = 5;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg(argv[i]);
+
+        if (arg.rfind("-width=", 0) == 0)
+            width = std::stoul(arg.substr(7));
+        else if (arg.rfind("-depth=", 0) == 0)
+            depth = std::stoul(arg.substr(7));
+        else if (arg.rfind("-factorial=", 0) == 0)
+            factorialOf = std::stoul(arg.substr(11));
+        else if (arg.rfind("-fibonacci=", 0) == 0)
+            fibonacciOf = std::stoul(arg.substr(11));
+        else if (arg.rfind("-squarings=", 0) == 0)
+            squaringCount = std::stoul(arg.substr(11));
+        else if (arg.rfind("-bigprint=", 0) == 0)
+            bigPrintSquarings = std::stoul(arg.substr(10));
+        else if (arg.rfind("-augs=", 0) == 0)
+            augCount = std::stoul(arg.substr(6));
+        else if (arg.rfind("-concs=", 0) == 0)
+            concCount = std::stoul(arg.substr(7));
+        else if (arg.rfind("-iterations=", 0) == 0)
+            iterations = std::stoi(arg.substr(12));
+    }
+
+    struct Input
+    {
+        const char *name;
+        std::string source;
+    };
+
+    std::vector<Input> inputs = {
+            {"wide arithmetic", wideArithmetic(width)},
+            {"wide comparisons", wideComparisons(width)},
+            {"wide ->", wideConditionals(width)},
+            {"deep recursion", deepSum(depth)},
+            {"tail loop", tailLoop(depth * 10)},
+            {"factorial", factorial(factorialOf)},
+            {"fibonacci", fibonacci(fibonacciOf)},
+            {"squarings", squarings(squaringCount)},
+            {"big print", bigPrint(bigPrintSquarings)},
+            {"aug loop", augLoop(augCount)},
+            {"string loop", concLoop(concCount)},
+    };
+
+    std::cout << "width " << width << ", depth " << depth << std::endl;
+
+    for (const Input &input : inputs)
+    {
+        Lexer lexer(input.source);
+        CompilationContext ctx(lexer);
+        Parser::parse(ctx);
+
+        CSE compiler;
+        compiler.create_cs(ctx.tree.getSTRoot());
+        const Program &program = compiler.get_program();
+
+        double best = 0;
+        std::string output;
+        std::string error;
+
+        for (int i = 0; i < iterations && error.empty(); i++)
+        {
+            std::ostringstream out;
+            CSE cse(out);
+            cse.set_program(program);
+
+            auto begin = std::chrono::steady_clock::now();
+            try
+            {
+                cse.evaluate();
+            }
+            catch (const std::exception &e)
+            {
+                error = e.what();
+                break;
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+            if (i == 0 || elapsed.count() < best)
+                best = elapsed.count();
+            output = out.str();
+        }
+
+        if (!error.empty())
+            std::cout << input.name << ":\t" << error << std::endl;
+        else if (output.size() > 40)
+            std::cout << input.name << ":\t" << best * 1000 << " ms (prints " << output.substr(0, 20) << "..., "
+                      << output.size() << " digits)" << std::endl;
+        else
+            std::cout << input.name << ":\t" << best * 1000 << " ms (prints " << output << ")" << std::endl;
+    }
+
+    return 0;
+}
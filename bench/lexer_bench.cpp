@@ -0,0 +1,103 @@
+// Lexer microbenchmark.
+//
+// Lexes a large RPAL source repeatedly and reports tokens/sec and MB/sec.
+//
+//     lexer_bench [input_file] [-mb=SIZE] [-iterations=N]
+//
+// Without an input file a synthetic program of SIZE megabytes (default 32) is generated
+// that mixes identifiers, keywords, integers, operators, strings and comments.
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "../Lexer.h"
+#include "../SourceBuffer.h"
+
+static std::string generateSource(size_t targetBytes)
+{
+    static const char *block =
+            "// helper functions for the generated workload\n"
+            "let rec fib_counter n = n ls 2 -> n | fib_counter (n - 1) + fib_counter (n - 2)\n"
+            "and concat_all (s, t) = Conc s t\n"
+            "within total_sum = (1, 22, 333, 4444) aug 55555\n"
+            "in Print (fib_counter 20 ge 100 & not (total_sum eq nil), 'a string literal', 'tab\\there')\n"
+            "where value_with_long_name = 1234567 * 89 / 3 ** 2 -> true | false\n";
+
+    std::string source;
+    source.reserve(targetBytes + 512);
+    while (source.size() < targetBytes)
+    {
+        source += block;
+    }
+    return source;
+}
+
+int main(int argc, char *argv[])
+{
+    std::string filename;
+    size_t megabytes = 32;
+    int iterations = 5;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg(argv[i]);
+
+        if (arg.rfind("-mb=", 0) == 0)
+            megabytes = std::stoul(arg.substr(4));
+        else if (arg.rfind("-iterations=", 0) == 0)
+            iterations = std::stoi(arg.substr(12));
+        else
+            filename = arg;
+    }
+
+    std::string generated;
+    std::string_view input;
+    SourceBuffer *source = nullptr;
+
+    if (!filename.empty())
+    {
+        source = new SourceBuffer(filename);
+        if (!source->isOpen())
+        {
+            std::cout << "Unable to open file: " << filename << std::endl;
+            return 1;
+        }
+        input = source->view();
+    }
+    else
+    {
+        generated = generateSource(megabytes * 1024 * 1024);
+        input = generated;
+    }
+
+    size_t tokens = 0;
+    double bestSeconds = 0;
+
+    for (int i = 0; i < iterations; i++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+
+        Lexer lexer(input);
+        size_t count = 0;
+        while (lexer.getNextToken().type != token_type::END_OF_FILE)
+        {
+            count++;
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+        if (i == 0 || elapsed.count() < bestSeconds)
+            bestSeconds = elapsed.count();
+        tokens = count;
+    }
+
+    double megabytesLexed = static_cast<double>(input.size()) / (1024.0 * 1024.0);
+
+    std::cout << "input:       " << megabytesLexed << " MB, " << tokens << " tokens" << std::endl;
+    std::cout << "best time:   " << bestSeconds * 1000.0 << " ms (of " << iterations << " runs)" << std::endl;
+    std::cout << "throughput:  " << static_cast<double>(tokens) / bestSeconds / 1e6 << " M tokens/sec, "
+              << megabytesLexed / bestSeconds << " MB/sec" << std::endl;
+
+    delete source;
+    return 0;
+}
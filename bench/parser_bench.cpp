@@ -0,0 +1,174 @@
+// Parser benchmark.
+//
+// Measures parse throughput (lexing included) on generated programs that are either very
+// deeply nested or very wide, the two shapes that stress the parse stack and the node stack.
+//
+//     parser_bench [-depth=N] [-width=N] [-iterations=N] [-limit=BYTES] [-standardize]
+//
+// Deep inputs nest N levels (default 1000000) of parentheses, lets or conditionals; wide
+// inputs chain N (default 1000000) operands with +, a mix of every operator, commas or
+// "and". -limit sets the parse stack limit, to check that a program over it fails with a
+// syntax error instead of crashing. -standardize builds the ST while parsing instead of the AST.
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../CompilationContext.h"
+#include "../Lexer.h"
+#include "../Parser.h"
+
+static std::string nestedParens(size_t depth)
+{
+    return std::string(depth, '(') + "1" + std::string(depth, ')');
+}
+
+static std::string nestedLets(size_t depth)
+{
+    std::string source;
+    for (size_t i = 0; i < depth; i++)
+        source += "let x = x in ";
+    return source + "x";
+}
+
+static std::string nestedConditionals(size_t depth)
+{
+    std::string source;
+    for (size_t i = 0; i < depth; i++)
+        source += "x -> 1 | ";
+    return source + "0";
+}
+
+static std::string longSum(size_t width)
+{
+    std::string source = "1";
+    for (size_t i = 1; i < width; i++)
+        source += " + 1";
+    return source;
+}
+
+static std::string mixedOperators(size_t width)
+{
+    std::string source;
+    for (size_t i = 0; i < width; i += 8)
+        source += "a * 2 + b / 3 - c ** 2 ls d & not e or ";
+    return source + "f";
+}
+
+static std::string longTuple(size_t width)
+{
+    std::string source = "1";
+    for (size_t i = 1; i < width; i++)
+        source += ", " + std::to_string(i);
+    return source;
+}
+
+static std::string manyDefinitions(size_t width)
+{
+    std::string source = "let x0 = 0";
+    for (size_t i = 1; i < width; i++)
+        source += " and x" + std::to_string(i) + " = " + std::to_string(i);
+    return source + " in x0";
+}
+
+// Counts the nodes without recursing, since the trees are as deep as the input
+static size_t countNodes(TreeNode *root)
+{
+    size_t count = 0;
+    std::vector<TreeNode *> pending = {root};
+    while (!pending.empty())
+    {
+        TreeNode *node = pending.back();
+        pending.pop_back();
+        count++;
+        for (TreeNode *child : node->getChildren())
+            pending.push_back(child);
+    }
+    return count;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t depth = 1000000;
+    size_t width = 1000000;
+    size_t limit = CompilationContext::DEFAULT_PARSE_STACK_LIMIT;
+    int iterations = 5;
+    bool standardize = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg(argv[i]);
+
+        if (arg.rfind("-depth=", 0) == 0)
+            depth = std::stoul(arg.substr(7));
+        else if (arg.rfind("-width=", 0) == 0)
+            width = std::stoul(arg.substr(7));
+        else if (arg.rfind("-iterations=", 0) == 0)
+            iterations = std::stoi(arg.substr(12));
+        else if (arg.rfind("-limit=", 0) == 0)
+            limit = std::stoul(arg.substr(7));
+        else if (arg == "-standardize")
+            standardize = true;
+    }
+
+    struct Input
+    {
+        const char *name;
+        std::string source;
+    };
+
+    std::vector<Input> inputs = {
+            {"deep parens", nestedParens(depth)},
+            {"deep let", nestedLets(depth)},
+            {"deep ->", nestedConditionals(depth)},
+            {"wide +", longSum(width)},
+            {"wide mixed", mixedOperators(width)},
+            {"wide tuple", longTuple(width)},
+            {"wide and", manyDefinitions(width)},
+    };
+
+    std::cout << "depth " << depth << ", width " << width << ", parse stack limit " << limit << " bytes"
+              << (standardize ? ", standardizing while parsing" : "") << std::endl;
+
+    for (const Input &input : inputs)
+    {
+        double best = 0;
+        size_t nodes = 0;
+        std::string error;
+
+        for (int i = 0; i < iterations && error.empty(); i++)
+        {
+            Lexer lexer(input.source);
+            CompilationContext ctx(lexer);
+            ctx.parseStackLimit = limit;
+            ctx.standardizeWhileParsing = standardize;
+
+            auto begin = std::chrono::steady_clock::now();
+            try
+            {
+                Parser::parse(ctx);
+            }
+            catch (const std::exception &e)
+            {
+                error = e.what();
+                break;
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+            if (i == 0 || elapsed.count() < best)
+                best = elapsed.count();
+            nodes = countNodes(standardize ? ctx.tree.getSTRoot() : ctx.tree.getASTRoot());
+        }
+
+        double megabytes = static_cast<double>(input.source.size()) / (1024.0 * 1024.0);
+        if (!error.empty())
+            std::cout << input.name << ":\t" << error << std::endl;
+        else
+            std::cout << input.name << ":\t" << megabytes / best << " MB/sec, " << static_cast<double>(nodes) / best / 1e6
+                      << " M nodes/sec (" << nodes << " nodes, " << best * 1000 << " ms)" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+// Scan kernel benchmark.
+//
+// Compares the scalar, SSE2 and AVX2 lexer scan kernels on a whitespace-heavy source,
+// both in isolation and as part of a full lexer pass.
+//
+//     scan_bench [input_file] [-mb=SIZE] [-iterations=N]
+//
+// Without an input file a synthetic program of SIZE megabytes (default 32) is generated
+// that is mostly indentation, comment banners and long identifiers.
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../Lexer.h"
+#include "../ScanKernels.h"
+#include "../SourceBuffer.h"
+
+static std::string generateSource(size_t targetBytes)
+{
+    static const char *block =
+            "//////////////////////////////////////////////////////////////////////////////////////\n"
+            "//  Generated section: the lines below are indented the way our generator emits them  \n"
+            "//////////////////////////////////////////////////////////////////////////////////////\n"
+            "let\n"
+            "                                        accumulated_value_for_this_section = 42\n"
+            "                                                                                  \n"
+            "in\n"
+            "                                        Print ( accumulated_value_for_this_section )\n"
+            "\t\t\t\t\t\t\t\t\t\t\t\t\n";
+
+    std::string source;
+    source.reserve(targetBytes + 512);
+    while (source.size() < targetBytes)
+    {
+        source += block;
+    }
+    return source;
+}
+
+template <typename F>
+static double bestOf(int iterations, F &&run)
+{
+    double best = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        run();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+        if (i == 0 || elapsed.count() < best)
+            best = elapsed.count();
+    }
+    return best;
+}
+
+int main(int argc, char *argv[])
+{
+    std::string filename;
+    size_t megabytes = 32;
+    int iterations = 5;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg(argv[i]);
+
+        if (arg.rfind("-mb=", 0) == 0)
+            megabytes = std::stoul(arg.substr(4));
+        else if (arg.rfind("-iterations=", 0) == 0)
+            iterations = std::stoi(arg.substr(12));
+        else
+            filename = arg;
+    }
+
+    std::string generated;
+    std::string_view input;
+    SourceBuffer *source = nullptr;
+
+    if (!filename.empty())
+    {
+        source = new SourceBuffer(filename);
+        if (!source->isOpen())
+        {
+            std::cout << "Unable to open file: " << filename << std::endl;
+            return 1;
+        }
+        input = source->view();
+    }
+    else
+    {
+        generated = generateSource(megabytes * 1024 * 1024);
+        input = generated;
+    }
+
+    std::vector<const ScanKernels *> candidates = {&scalarScanKernels(), sse2ScanKernels(), avx2ScanKernels()};
+    double megabytesScanned = static_cast<double>(input.size()) / (1024.0 * 1024.0);
+    size_t expectedTokens = 0;
+
+    std::cout << "input: " << megabytesScanned << " MB, default kernels: " << defaultScanKernels().name << std::endl;
+
+    for (const ScanKernels *kernels : candidates)
+    {
+        if (kernels == nullptr)
+            continue;
+
+        // Kernels alone: alternate whitespace runs with identifier runs and skip comments
+        size_t checksum = 0;
+        double kernelSeconds = bestOf(iterations, [&]() {
+            const char *data = input.data();
+            size_t length = input.size();
+            size_t position = 0;
+            checksum = 0;
+
+            while (position < length)
+            {
+                position = kernels->skipWhitespace(data, position, length);
+                if (position + 1 < length && data[position] == '/' && data[position + 1] == '/')
+                    position = kernels->findNewline(data, position, length);
+                else
+                    position = kernels->skipIdentifier(data, position, length) + 1;
+                checksum++;
+            }
+        });
+
+        // Full lexer pass using the kernels
+        size_t tokens = 0;
+        double lexerSeconds = bestOf(iterations, [&]() {
+            Lexer lexer(input, *kernels);
+            tokens = 0;
+            while (lexer.getNextToken().type != token_type::END_OF_FILE)
+                tokens++;
+        });
+
+        if (expectedTokens == 0)
+            expectedTokens = tokens;
+        else if (tokens != expectedTokens)
+            std::cout << "MISMATCH: " << kernels->name << " produced " << tokens << " tokens, expected "
+                      << expectedTokens << std::endl;
+
+        std::cout << kernels->name << ":\tkernels " << megabytesScanned / kernelSeconds << " MB/sec ("
+                  << checksum << " runs),\tlexer " << megabytesScanned / lexerSeconds << " MB/sec, "
+                  << static_cast<double>(tokens) / lexerSeconds / 1e6 << " M tokens/sec" << std::endl;
+    }
+
+    delete source;
+    return 0;
+}
@@ -1,38 +1,134 @@
 #include <string>
-#include <fstream>
 #include <iostream>
 #include <filesystem>
+#include <charconv>
+#include <chrono>
+#include <thread>
 
+#include "SourceBuffer.h"
 #include "Parser.h"
 #include "CSE.h"
 #include "Viz.h"
+#include "Batch.h"
+#include "CsCache.h"
+
+/**
+ * Reads the thread count given to -j.
+ *
+ * @param text: The argument, which must be a whole non-negative number that fits in an unsigned.
+ * @param threads: Set to the count if the argument is valid.
+ * @return Whether the argument is valid.
+ */
+static bool parseThreadCount(const std::string &text, unsigned &threads)
+{
+    const char *end = text.data() + text.size();
+    auto [last, error] = std::from_chars(text.data(), end, threads);
+    return error == std::errc() && last == end && !text.empty();
+}
+
+/**
+ * Runs every program named by a directory or list file and prints their outputs in input order.
+ * Usage: rpal20 --batch (directory | list_file) [-j N]
+ */
+int batchMain(int argc, char *argv[])
+{
+    std::string input;
+    unsigned threads = 0;
+    bool valid = true;
+
+    for (int i = 2; i < argc && valid; ++i)
+    {
+        std::string arg(argv[i]);
+
+        if (arg == "-j")
+        {
+            valid = i + 1 < argc && parseThreadCount(argv[++i], threads);
+        }
+        else if (arg.rfind("-j", 0) == 0)
+        {
+            valid = parseThreadCount(arg.substr(2), threads);
+        }
+        else
+        {
+            input = arg;
+        }
+    }
+
+    if (!valid || input.empty())
+    {
+        std::cout << "\033[1;31mERROR: \033[0m"
+                  << (valid ? "" : "-j expects a number of threads. ")
+                  << "Usage: .\\rpal20 --batch (directory | list_file) [-j N]"
+                  << "\n"
+                  << std::endl;
+        return 1;
+    }
+
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::vector<std::string> files;
+    try
+    {
+        files = collectBatchInputs(input);
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<BatchResult> results = runBatch(files, threads);
+    auto end = std::chrono::steady_clock::now();
+
+    writeBatchResults(results, std::cout);
+    writeBatchSummary(results, threads, std::chrono::duration<double, std::milli>(end - start).count(), std::cerr);
+
+    for (const BatchResult &result : results)
+    {
+        if (result.failed)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
 
 int main(int argc, char *argv[])
 {
+    if (argc >= 2 && std::string(argv[1]) == "--batch")
+    {
+        return batchMain(argc, argv);
+    }
+
     if (argc < 2 || std::string(argv[1]) == "-visualize")
     {
         std::cout << "\033[1;31mERROR: \033[0m"
-                  << "Usage: .\\rpal20 input_file [-visualize=VALUE]"
+                  << "Usage: .\\rpal20 input_file [-visualize=VALUE] [-stats] [-cache[=DIR]] [-disassemble] | --batch (directory | list_file) [-j N]"
                   << "\n"
                   << std::endl;
         return 1;
     }
 
     std::string filename = argv[1];
-    std::ifstream file(filename);
+    SourceBuffer source(filename);
 
-    if (!file.is_open())
+    if (!source.isOpen())
     {
         std::cout << "Unable to open file: " << filename << std::endl;
         return 1;
     }
 
-    std::string input((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-
     // Check if the "-visualize" argument is provided
     std::string visualizeArg;
     bool visualizeAst = false;
     bool visualizeSt = false;
+    bool showStats = false;
+    bool disassembleProgram = false;
+    std::string cacheDirectory;
 
     for (int i = 2; i < argc; ++i)
     {
@@ -51,6 +147,22 @@ int main(int argc, char *argv[])
         {
             visualizeSt = true;
         }
+        else if (arg == "-stats")
+        {
+            showStats = true;
+        }
+        else if (arg == "-disassemble")
+        {
+            disassembleProgram = true;
+        }
+        else if (arg == "-cache")
+        {
+            cacheDirectory = ".rpalcache";
+        }
+        else if (arg.rfind("-cache=", 0) == 0)
+        {
+            cacheDirectory = arg.substr(7);
+        }
     }
 
     if (!isGraphvizInstalled() && (visualizeAst || visualizeSt))
@@ -66,25 +178,57 @@ int main(int argc, char *argv[])
         }
     }
 
-    Lexer lexer(input);
+    // Visualizing needs the trees, so it always compiles from source
+    bool useCache = !cacheDirectory.empty() && !visualizeAst && !visualizeSt;
+    CsCacheKey cacheKey;
+    std::string cachePath;
 
-    TokenStorage &tokenStorage = TokenStorage::getInstance();
-    tokenStorage.setLexer(lexer);
+    if (useCache)
+    {
+        cacheKey = csCacheKey(source.view());
+        cachePath = csCachePath(cacheDirectory, cacheKey);
+
+        CSE cse = CSE();
+        if (loadCachedProgram(cachePath, cacheKey, cse))
+        {
+            if (showStats)
+            {
+                std::cerr << "Bytecode: loaded " << cse.get_program().blocks.size() << " blocks from " << cachePath
+                          << std::endl;
+            }
+
+            if (disassembleProgram)
+            {
+                disassemble(cse.get_program(), std::cout);
+                return 0;
+            }
+
+            cse.evaluate();
+            std::cout << std::endl;
+            return 0;
+        }
+    }
+
+    Lexer lexer(source.view());
+    CompilationContext ctx(lexer);
+
+    // Only keep the AST when it is going to be visualized; otherwise parse straight into the ST
+    ctx.standardizeWhileParsing = !visualizeAst;
 
 //     Token token;
 //     do
 //     {
-//         token = TokenStorage::getInstance().pop();
+//         token = ctx.tokenStorage.pop();
 //         std::cout << "Type: " << gettoken_typeName(token.type) << ", Value: " << token.value << std::endl;
 //         // std::cout << token.value << std::endl;
 //     } while (token.type != token_type::END_OF_FILE);
 //
-//     TokenStorage::getInstance().reset();
+//     ctx.tokenStorage.reset();
 
-    Parser::parse();
-    TokenStorage::destroyInstance();
+    Parser::parse(ctx);
+    ctx.tokenStorage.clear();
 
-    TreeNode *root = Tree::getInstance().getASTRoot();
+    TreeNode *root = ctx.tree.getASTRoot();
 
     if (visualizeAst)
     {
@@ -101,8 +245,13 @@ int main(int argc, char *argv[])
         std::cout << "The ast.png file is located in the Visualizations folder." << std::endl;
     }
 
-    Tree::generate();
-    TreeNode *st_root = Tree::getInstance().getSTRoot();
+    ctx.tree.generate();
+    TreeNode *st_root = ctx.tree.getSTRoot();
+
+    if (showStats)
+    {
+        ctx.tree.writeMemoryReport(std::cerr);
+    }
 
     if (visualizeSt)
     {
@@ -118,7 +267,19 @@ int main(int argc, char *argv[])
     }
 
     CSE cse = CSE();
-    cse.create_cs(Tree::getInstance().getSTRoot());
+    cse.create_cs(ctx.tree.getSTRoot());
+
+    if (useCache && !saveCachedProgram(cachePath, cacheKey, cse))
+    {
+        std::cerr << "Warning: could not write the control structure cache " << cachePath << std::endl;
+    }
+
+    if (disassembleProgram)
+    {
+        disassemble(cse.get_program(), std::cout);
+        return 0;
+    }
+
     cse.evaluate();
 
     std::cout << std::endl;